@@ -3,12 +3,18 @@
 
 #include "algorithm.h"
 
+#include <stdint.h>
+
 #include <cassert>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "fairness_constraint.h"
 #include "matroid.h"
 #include "submodular_function.h"
+#include "subroutine_cache.h"
+#include "utilities.h"
 
 void Algorithm::Init(const SubmodularFunction& sub_func_f,
                      const FairnessConstraint& fairness,
@@ -19,6 +25,36 @@ void Algorithm::Init(const SubmodularFunction& sub_func_f,
   fairness_->Reset();
   matroid_ = matroid.Clone();
   matroid_->Reset();
+  warm_start_.clear();
+  cache_ = nullptr;
+}
+
+void Algorithm::SetWarmStart(const std::vector<int>& warm_start) {
+  warm_start_ = warm_start;
+}
+
+void Algorithm::SetSubroutineCache(SubroutineCache* cache) { cache_ = cache; }
+
+int Algorithm::GetNumberOfVariants() const { return 1; }
+
+std::string Algorithm::GetVariantName(int variant) const {
+  assert(variant == 0);
+  return GetAlgorithmName();
+}
+
+double Algorithm::GetVariantSolutionValue(int variant) {
+  assert(variant == 0);
+  return GetSolutionValue();
+}
+
+const std::vector<int>& Algorithm::GetVariantSolutionVector(int variant) {
+  assert(variant == 0);
+  return GetSolutionVector();
+}
+
+int64_t Algorithm::GetVariantOracleCalls(int variant) const {
+  Fail("GetVariantOracleCalls() is not implemented for " + GetAlgorithmName());
+  return 0;
 }
 
 int Algorithm::GetNumberOfPasses() const {
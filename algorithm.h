@@ -4,6 +4,8 @@
 #ifndef FAIR_SUBMODULAR_MATROID_ALGORITHM_H_
 #define FAIR_SUBMODULAR_MATROID_ALGORITHM_H_
 
+#include <stdint.h>
+
 #include <memory>
 #include <string>
 #include <vector>
@@ -11,9 +13,11 @@
 #include "fairness_constraint.h"
 #include "matroid.h"
 #include "submodular_function.h"
+#include "subroutine_cache.h"
 
 // Any algorithm should be used as follows:
 // * Init()
+// * optionally SetWarmStart() and SetSubroutineCache()
 // * set SubmodularFunction::oracle_calls_ = 0
 // * n times Insert()
 // * if two-pass: BeginNextPass(), then again n times Insert()
@@ -21,6 +25,11 @@
 //   solution here)
 // * GetSolutionVector() (optional)
 // * read SubmodularFunction::oracle_calls_
+//
+// An algorithm may compute solutions for several parameter values in one run
+// (variants). Then GetVariantSolutionValue() and GetVariantSolutionVector()
+// are called for each variant instead, and GetVariantOracleCalls() replaces
+// oracle_calls_, which covers all of them.
 
 class Algorithm {
  public:
@@ -30,6 +39,17 @@ class Algorithm {
   virtual void Init(const SubmodularFunction& sub_func_f,
                     const FairnessConstraint& fairness, const Matroid& matroid);
 
+  // Lets the algorithm reuse subroutine results from `cache`, which is shared
+  // by all algorithms run on the arguments of Init() and must outlive the
+  // run. Optional; call after Init(), which clears it.
+  void SetSubroutineCache(SubroutineCache* cache);
+
+  // Passes a common independent set of the matroid and the lower bound
+  // matroid of the fairness constraint (e.g. a maximum one, as computed by the
+  // caller's feasibility check) that the algorithm may start its own
+  // intersection from. Optional; call after Init(), which clears it.
+  void SetWarmStart(const std::vector<int>& warm_start);
+
   // Handles insertion of an element.
   virtual void Insert(int element) = 0;
 
@@ -37,11 +57,29 @@ class Algorithm {
   virtual double GetSolutionValue() = 0;
 
   // Gets current solution. Only call this after calling GetSolutionValue().
-  virtual std::vector<int> GetSolutionVector() = 0;
+  virtual const std::vector<int>& GetSolutionVector() = 0;
 
   // Gets the name of the algorithm.
   virtual std::string GetAlgorithmName() const = 0;
 
+  // Returns the number of variants the algorithm reports. Default is 1.
+  virtual int GetNumberOfVariants() const;
+
+  // Gets the name of a variant. Default is GetAlgorithmName().
+  virtual std::string GetVariantName(int variant) const;
+
+  // Gets the solution value of a variant. Default is GetSolutionValue().
+  virtual double GetVariantSolutionValue(int variant);
+
+  // Gets the solution of a variant. Only call this after calling
+  // GetVariantSolutionValue() for it. Default is GetSolutionVector().
+  virtual const std::vector<int>& GetVariantSolutionVector(int variant);
+
+  // Returns the number of oracle calls a run of only this variant would have
+  // made since Init(). Only call this after calling GetVariantSolutionValue()
+  // for it. Algorithms with several variants must override it.
+  virtual int64_t GetVariantOracleCalls(int variant) const;
+
   // Returns the number of passes the algorithm makes (1 or 2 for us). Default
   // is 1.
   virtual int GetNumberOfPasses() const;
@@ -62,6 +100,12 @@ class Algorithm {
 
   // Matroid.
   std::unique_ptr<Matroid> matroid_;
+
+  // See SetWarmStart().
+  std::vector<int> warm_start_;
+
+  // See SetSubroutineCache(); nullptr if not set.
+  SubroutineCache* cache_ = nullptr;
 };
 
 #endif  // FAIR_SUBMODULAR_MATROID_ALGORITHM_H_
@@ -3,6 +3,8 @@
 
 #include "approximate_fairness_algorithm.h"
 
+#include <stdint.h>
+
 #include <memory>
 #include <string>
 #include <vector>
@@ -13,11 +15,24 @@
 #include "matroid.h"
 #include "matroid_intersection.h"
 #include "submodular_function.h"
+#include "utilities.h"
 
 // WARNING: ONLY IMPLEMENTED FOR PARTITION MATROIDS!
 
-ApproximateFairnessAlgorithm::ApproximateFairnessAlgorithm(double epsilon)
-    : epsilon_(epsilon) {}
+ApproximateFairnessAlgorithm::ApproximateFairnessAlgorithm(
+    double epsilon, const GreedyOptions& greedy_options)
+    : epsilon_(epsilon), greedy_options_(greedy_options) {}
+
+ApproximateFairnessAlgorithm::ApproximateFairnessAlgorithm(
+    const std::vector<double>& epsilons, const GreedyOptions& greedy_options)
+    : epsilon_(epsilons.empty() ? 0 : epsilons[0]),
+      sweep_(true),
+      epsilons_(epsilons),
+      greedy_options_(greedy_options) {
+  if (epsilons.empty()) {
+    Fail("the epsilon sweep needs at least one epsilon");
+  }
+}
 
 void ApproximateFairnessAlgorithm::Init(const SubmodularFunction& sub_func_f,
                            const FairnessConstraint& fairness,
@@ -25,6 +40,10 @@ void ApproximateFairnessAlgorithm::Init(const SubmodularFunction& sub_func_f,
   Algorithm::Init(sub_func_f, fairness, matroid);
   matroid_->Reset();
   solution_.clear();
+  universe_elements_.clear();
+  sweep_solutions_.clear();
+  sweep_values_.clear();
+  sweep_oracle_calls_.clear();
 }
 
 void ApproximateFairnessAlgorithm::Insert(int element) {
@@ -33,19 +52,108 @@ void ApproximateFairnessAlgorithm::Insert(int element) {
 
 // WARNING: ONLY IMPLEMENTED FOR PARTITION MATROIDS!
 double ApproximateFairnessAlgorithm::GetSolutionValue() {
+  if (sweep_) {
+    return GetVariantSolutionValue(0);
+  }
   // Run the approximate fairness algorithm.
   assert(matroid_ != nullptr);
   ApproximateFairSubmodularMaximization(static_cast<PartitionMatroid*>(matroid_.get()),
     fairness_.get(),
     sub_func_f_.get(),
-    epsilon_
+    epsilon_,
+    greedy_options_,
+    cache_
   );
   solution_ = matroid_->GetCurrent();
   return sub_func_f_->ObjectiveAndIncreaseOracleCall(solution_);
 }
 
-std::vector<int> ApproximateFairnessAlgorithm::GetSolutionVector() { return solution_; }
+const std::vector<int>& ApproximateFairnessAlgorithm::GetSolutionVector() {
+  if (sweep_) {
+    return GetVariantSolutionVector(0);
+  }
+  return solution_;
+}
+
+// WARNING: ONLY IMPLEMENTED FOR PARTITION MATROIDS!
+void ApproximateFairnessAlgorithm::SolveSweep() {
+  assert(matroid_ != nullptr);
+  PartitionMatroid* matroid = static_cast<PartitionMatroid*>(matroid_.get());
+  // The cache charges the oracle calls of a reused decomposition.
+  const FairPathDecomposition decomposition =
+      cache_ != nullptr
+          ? cache_->DecomposeFairPaths(matroid, fairness_.get(),
+                                       sub_func_f_.get(), greedy_options_)
+          : DecomposeFairPaths(matroid, fairness_.get(), sub_func_f_.get(),
+                               greedy_options_, nullptr);
+  // Same precision as ApproximateFairSubmodularMaximization().
+  std::vector<float> epsilons(epsilons_.begin(), epsilons_.end());
+  sweep_solutions_ = ApplyFairPathPrefixes(matroid, fairness_.get(),
+                                           decomposition, epsilons);
+  sweep_values_.clear();
+  sweep_oracle_calls_.clear();
+  for (const std::vector<int>& solution : sweep_solutions_) {
+    // The same evaluations as a separate instance makes after the paths.
+    const int64_t oracle_calls_before = SubmodularFunction::oracle_calls_;
+    PrintFairPathSummary(sub_func_f_.get(), decomposition, solution);
+    sweep_values_.push_back(
+        sub_func_f_->ObjectiveAndIncreaseOracleCall(solution));
+    sweep_oracle_calls_.push_back(decomposition.oracle_calls +
+                                  SubmodularFunction::oracle_calls_ -
+                                  oracle_calls_before);
+  }
+}
+
+std::string ApproximateFairnessAlgorithm::GetNameForEpsilon(
+    double epsilon) const {
+  const std::string greedy = GreedyOptionsToString(greedy_options_);
+  return "Approximate Fairness Algorithm (epsilon=" + std::to_string(epsilon) +
+         (greedy.empty() ? "" : ", " + greedy) + ")";
+}
 
 std::string ApproximateFairnessAlgorithm::GetAlgorithmName() const {
-  return "Approximate Fairness Algorithm (epsilon=" + std::to_string(epsilon_) + ")";
+  if (!sweep_) {
+    return GetNameForEpsilon(epsilon_);
+  }
+  std::string epsilons;
+  for (double epsilon : epsilons_) {
+    epsilons += (epsilons.empty() ? "" : ",") + std::to_string(epsilon);
+  }
+  const std::string greedy = GreedyOptionsToString(greedy_options_);
+  return "Approximate Fairness Algorithm (epsilon sweep " + epsilons +
+         (greedy.empty() ? "" : ", " + greedy) + ")";
+}
+
+int ApproximateFairnessAlgorithm::GetNumberOfVariants() const {
+  return sweep_ ? epsilons_.size() : 1;
+}
+
+std::string ApproximateFairnessAlgorithm::GetVariantName(int variant) const {
+  return sweep_ ? GetNameForEpsilon(epsilons_[variant]) : GetAlgorithmName();
+}
+
+double ApproximateFairnessAlgorithm::GetVariantSolutionValue(int variant) {
+  if (!sweep_) {
+    return GetSolutionValue();
+  }
+  if (sweep_values_.empty()) {
+    SolveSweep();
+  }
+  return sweep_values_[variant];
+}
+
+int64_t ApproximateFairnessAlgorithm::GetVariantOracleCalls(
+    int variant) const {
+  if (!sweep_) {
+    return Algorithm::GetVariantOracleCalls(variant);
+  }
+  return sweep_oracle_calls_[variant];
+}
+
+const std::vector<int>&
+ApproximateFairnessAlgorithm::GetVariantSolutionVector(int variant) {
+  if (!sweep_) {
+    return GetSolutionVector();
+  }
+  return sweep_solutions_[variant];
 }
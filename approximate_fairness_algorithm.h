@@ -4,6 +4,8 @@
 #ifndef FAIR_SUBMODULAR_MATROID_APPROXIMATE_FAIRNESS_ALGORITHM_H_
 #define FAIR_SUBMODULAR_MATROID_APPROXIMATE_FAIRNESS_ALGORITHM_H_
 
+#include <stdint.h>
+
 #include <memory>
 #include <string>
 #include <vector>
@@ -11,14 +13,28 @@
 #include "algorithm.h"
 #include "fairness_constraint.h"
 #include "matroid.h"
+#include "matroid_intersection.h"
 #include "submodular_function.h"
 
 // WARNING: ONLY IMPLEMENTED FOR PARTITION MATROIDS!
 
 class ApproximateFairnessAlgorithm : public Algorithm {
  public:
-  // Constructor with epsilon parameter.
-  explicit ApproximateFairnessAlgorithm(double epsilon);
+  // Constructor with epsilon parameter; greedy_options selects the greedy
+  // variant used to build the set Y.
+  explicit ApproximateFairnessAlgorithm(
+      double epsilon, const GreedyOptions& greedy_options = GreedyOptions());
+
+  // Epsilon-sweep mode: reports one variant per epsilon, with the same
+  // solutions as separate instances for each of them. P, Y and the paths are
+  // computed once per SubroutineCache (i.e. for the repeated runs of one
+  // rank; without a cache or with stochastic greedy they are recomputed in
+  // every run), and each run shuffles the paths once for all epsilons. Each
+  // epsilon is charged the oracle calls its own instance would make, i.e.,
+  // those of P, Y and the paths in every run, even if they are reused.
+  explicit ApproximateFairnessAlgorithm(
+      const std::vector<double>& epsilons,
+      const GreedyOptions& greedy_options = GreedyOptions());
 
   // Initialize the algorithm state.
   void Init(const SubmodularFunction& sub_func_f,
@@ -32,18 +48,51 @@ class ApproximateFairnessAlgorithm : public Algorithm {
   double GetSolutionValue() override;
 
   // Gets current solution. Only call this after calling GetSolutionValue().
-  std::vector<int> GetSolutionVector() override;
+  const std::vector<int>& GetSolutionVector() override;
 
   // Gets the name of the algorithm.
   std::string GetAlgorithmName() const override;
 
+  // In epsilon-sweep mode, the number of epsilons; 1 otherwise.
+  int GetNumberOfVariants() const override;
+
+  // Gets the name the algorithm has for a single epsilon.
+  std::string GetVariantName(int variant) const override;
+
+  // Gets the solution value for an epsilon.
+  double GetVariantSolutionValue(int variant) override;
+
+  // Gets the solution for an epsilon. Only call this after calling
+  // GetVariantSolutionValue().
+  const std::vector<int>& GetVariantSolutionVector(int variant) override;
+
+  // Gets the oracle calls of a separate instance for an epsilon.
+  int64_t GetVariantOracleCalls(int variant) const override;
+
  protected:
+  // Computes the solutions for all epsilons in epsilon-sweep mode.
+  void SolveSweep();
+
+  // Returns the name for a single epsilon.
+  std::string GetNameForEpsilon(double epsilon) const;
+
   // The final solution set.
   std::vector<int> solution_;
 
   std::vector<int> universe_elements_;
 
   double epsilon_;
+
+  // Epsilon-sweep mode: the epsilons, and the solutions and their values
+  // (empty until computed).
+  bool sweep_ = false;
+  std::vector<double> epsilons_;
+  std::vector<std::vector<int>> sweep_solutions_;
+  std::vector<double> sweep_values_;
+  std::vector<int64_t> sweep_oracle_calls_;
+
+  // Which variant of Greedy() to use.
+  GreedyOptions greedy_options_;
 };
 
 #endif  // FAIR_SUBMODULAR_MATROID_APPROXIMATE_FAIRNESS_ALGORITHM_H_
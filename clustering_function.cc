@@ -4,34 +4,49 @@
 #include "clustering_function.h"
 
 #include <assert.h>
+#include <stdint.h>
 
 #include <algorithm>
-#include <map>
+#include <limits>
 #include <memory>
-#include <set>
 #include <string>
 #include <vector>
 
+#include "pairwise_distance_cache.h"
 #include "submodular_function.h"
 
 using std::max;
 using std::min;
 
+// Number of candidates evaluated together in one pass over the points.
+constexpr int kDeltaBatchTileSize = 64;
+
+// Marks an empty second-best slot (-1 is the origin).
+constexpr int kNoCenter = -2;
+
 ClusteringFunction::ClusteringFunction(
-    const std::vector<std::vector<double>>& input) {
+    const std::vector<std::vector<double>>& input,
+    int64_t distance_cache_bytes) {
   input_ = input;
+  if (distance_cache_bytes > 0) {
+    distances_ =
+        std::make_shared<PairwiseDistanceCache>(input_, distance_cache_bytes);
+  }
   for (int i = 0; i < input_.size(); i++) {
     double dist_orig = distance(i, -1);  // distance to origin
     max_value_ += dist_orig;
-    min_dist_.push_back({dist_orig});
+    origin_dist_.push_back(dist_orig);
     universe_.push_back(i);
   }
+  Reset();
 }
 
 void ClusteringFunction::Reset() {
-  for (int i = 0; i < input_.size(); i++) {
-    min_dist_[i] = {distance(i, -1)};
-  }
+  best_dist_ = origin_dist_;
+  second_dist_.assign(input_.size(), std::numeric_limits<double>::infinity());
+  best_center_.assign(input_.size(), -1);
+  second_center_.assign(input_.size(), kNoCenter);
+  centers_.clear();
 }
 
 const std::vector<int>& ClusteringFunction::GetUniverse() const {
@@ -44,37 +59,84 @@ std::unique_ptr<SubmodularFunction> ClusteringFunction::Clone() const {
   return std::make_unique<ClusteringFunction>(*this);
 }
 
-void ClusteringFunction::Add(int element) {
-  for (int i = 0; i < input_.size(); ++i) {
-    min_dist_[i].insert(distance(element, i));
+template <typename Fn>
+void ClusteringFunction::ForEachDistance(int element, Fn fn) const {
+  if (distances_) {
+    const PairwiseDistanceCache::Row row = distances_->GetRow(element);
+    for (int i = 0; i < input_.size(); ++i) {
+      fn(i, row[i]);
+    }
+  } else {
+    for (int i = 0; i < input_.size(); ++i) {
+      fn(i, distance(element, i));
+    }
   }
 }
 
+void ClusteringFunction::Add(int element) {
+  centers_.push_back(element);
+  ForEachDistance(element, [this, element](int i, double dist) {
+    if (dist < best_dist_[i]) {
+      second_dist_[i] = best_dist_[i];
+      second_center_[i] = best_center_[i];
+      best_dist_[i] = dist;
+      best_center_[i] = element;
+    } else if (dist < second_dist_[i]) {
+      second_dist_[i] = dist;
+      second_center_[i] = element;
+    }
+  });
+}
+
 double ClusteringFunction::Delta(int element) {
   double res = 0.0;
-  for (int i = 0; i < input_.size(); ++i) {
-    res += max(0.0, *min_dist_[i].begin() - distance(element, i));
-  }
+  ForEachDistance(element, [this, &res](int i, double dist) {
+    res += max(0.0, best_dist_[i] - dist);
+  });
   return res;
 }
 
+void ClusteringFunction::DeltaBatch(const std::vector<int>& elements,
+                                    std::vector<double>* deltas) {
+  if (distances_ && distances_->IsDense()) {
+    // Rows are contiguous already, nothing to gain from tiling.
+    for (int j = 0; j < elements.size(); ++j) {
+      (*deltas)[j] = Delta(elements[j]);
+    }
+    return;
+  }
+  // Without the full matrix, a pass over many candidates would only cycle
+  // rows through the cache, so the distances are computed in tiles instead.
+  std::fill(deltas->begin(), deltas->end(), 0.0);
+  for (int begin = 0; begin < elements.size(); begin += kDeltaBatchTileSize) {
+    const int end =
+        min(begin + kDeltaBatchTileSize, static_cast<int>(elements.size()));
+    for (int i = 0; i < input_.size(); ++i) {
+      const double current = best_dist_[i];
+      for (int j = begin; j < end; ++j) {
+        (*deltas)[j] += max(0.0, current - distance(elements[j], i));
+      }
+    }
+  }
+}
+
 void ClusteringFunction::Remove(int element) {
+  auto it = std::find(centers_.begin(), centers_.end(), element);
+  assert(it != centers_.end());
+  centers_.erase(it);
   for (int i = 0; i < input_.size(); ++i) {
-    auto it = min_dist_[i].find(distance(element, i));
-    assert(it != min_dist_[i].end());
-    min_dist_[i].erase(it);
+    if (best_center_[i] == element || second_center_[i] == element) {
+      RecomputeNearest(i);
+    }
   }
 }
 
 double ClusteringFunction::RemovalDelta(int element) {
   double val = 0.0;
   for (int i = 0; i < input_.size(); ++i) {
-    const double eval = distance(element, i);
-    auto it = min_dist_[i].begin();
-    if (*it == eval) {
+    if (best_center_[i] == element) {
       // element is the current minimum, so we look at the second-best
-      ++it;
-      val += *it - eval;
+      val += second_dist_[i] - best_dist_[i];
     }  // else: element is not the current minimum, so removing it won't change
        // things
   }
@@ -84,18 +146,39 @@ double ClusteringFunction::RemovalDelta(int element) {
 // Not necessary, but overloaded for efficiency
 double ClusteringFunction::RemoveAndIncreaseOracleCall(int element) {
   ++oracle_calls_;
+  auto it = std::find(centers_.begin(), centers_.end(), element);
+  assert(it != centers_.end());
+  centers_.erase(it);
   double val = 0.0;
   for (int i = 0; i < input_.size(); ++i) {
-    const double before = *min_dist_[i].begin();
-    auto it = min_dist_[i].find(distance(element, i));
-    assert(it != min_dist_[i].end());
-    min_dist_[i].erase(it);
-    const double after = *min_dist_[i].begin();
-    val += after - before;
+    if (best_center_[i] == element || second_center_[i] == element) {
+      const double before = best_dist_[i];
+      RecomputeNearest(i);
+      val += best_dist_[i] - before;
+    }
   }
   return val;
 }
 
+void ClusteringFunction::RecomputeNearest(int i) {
+  best_dist_[i] = origin_dist_[i];
+  best_center_[i] = -1;
+  second_dist_[i] = std::numeric_limits<double>::infinity();
+  second_center_[i] = kNoCenter;
+  for (int center : centers_) {
+    const double dist = distance(center, i);
+    if (dist < best_dist_[i]) {
+      second_dist_[i] = best_dist_[i];
+      second_center_[i] = best_center_[i];
+      best_dist_[i] = dist;
+      best_center_[i] = center;
+    } else if (dist < second_dist_[i]) {
+      second_dist_[i] = dist;
+      second_center_[i] = center;
+    }
+  }
+}
+
 double ClusteringFunction::Objective(const std::vector<int>& elements) const {
   if (elements.empty()) {
     return 0;
@@ -113,6 +196,9 @@ double ClusteringFunction::Objective(const std::vector<int>& elements) const {
 }
 
 double ClusteringFunction::distance(int x, int y) const {
+  if (distances_ && y != -1) {
+    return distances_->Distance(x, y);
+  }
   double answer = 0;
   for (int i = 0; i < input_[x].size(); i++) {
     if (y == -1) {  // distance to origin
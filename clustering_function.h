@@ -4,17 +4,21 @@
 #ifndef FAIR_SUBMODULAR_MATROID_CLUSTERING_FUNCTION_H_
 #define FAIR_SUBMODULAR_MATROID_CLUSTERING_FUNCTION_H_
 
-#include <functional>
+#include <stdint.h>
+
 #include <memory>
-#include <set>
 #include <string>
 #include <vector>
 
+#include "pairwise_distance_cache.h"
 #include "submodular_function.h"
 
 class ClusteringFunction : public SubmodularFunction {
  public:
-  explicit ClusteringFunction(const std::vector<std::vector<double>>& input);
+  // If distance_cache_bytes > 0, pairwise distances are cached within that
+  // budget (see PairwiseDistanceCache); the cache is shared between clones.
+  explicit ClusteringFunction(const std::vector<std::vector<double>>& input,
+                              int64_t distance_cache_bytes = 0);
 
   void Reset() override;
 
@@ -35,18 +39,45 @@ class ClusteringFunction : public SubmodularFunction {
  protected:
   double Delta(int element) override;
 
+  // Reads the cached rows if the whole distance matrix is cached; otherwise
+  // walks the points once per tile of candidates instead of once per
+  // candidate.
+  void DeltaBatch(const std::vector<int>& elements,
+                  std::vector<double>* deltas) override;
+
   double RemovalDelta(int element) override;
 
   // F(S) = sum_{i in V} dist(i,-1) - min_{j in S U {-1}} dist(i, j)
   double Objective(const std::vector<int>& elements) const override;
 
  private:
-  // current distances: min_dist[i] = dist(i,-1) U {dist(i, j) : j in S}
-  std::vector<std::multiset<double, std::less<double>>> min_dist_;
+  // Recomputes the best and second-best distances of point i from the
+  // origin and the current centers.
+  void RecomputeNearest(int i);
 
   // Distance squared between two points, or to origin if y=-1
   double distance(int x, int y) const;
 
+  // Calls fn(i, distance(element, i)) for every point i.
+  template <typename Fn>
+  void ForEachDistance(int element, Fn fn) const;
+
+  // Cached pairwise distances, or nullptr if disabled.
+  std::shared_ptr<const PairwiseDistanceCache> distances_;
+
+  // For every point i, the two smallest values (and the centers attaining
+  // them, -1 for the origin) among dist(i,-1) U {dist(i, j) : j in S}.
+  std::vector<double> best_dist_;
+  std::vector<double> second_dist_;
+  std::vector<int> best_center_;
+  std::vector<int> second_center_;
+
+  // dist(i,-1) for every point i.
+  std::vector<double> origin_dist_;
+
+  // The current set S.
+  std::vector<int> centers_;
+
   // Coordinates of input points.
   std::vector<std::vector<double>> input_;
 
@@ -5,12 +5,29 @@
 
 #include <cassert>
 #include <memory>
-#include <set>
 #include <vector>
 
+#include "partition_matroid.h"
+#include "sparse_set.h"
+
+namespace {
+
+// Returns the set of distinct elements of `elements`.
+SparseSet ToSparseSet(const std::vector<int>& elements) {
+  SparseSet set;
+  for (int element : elements) {
+    if (!set.Contains(element)) {
+      set.Insert(element);
+    }
+  }
+  return set;
+}
+
+}  // namespace
+
 ConditionedMatroid::ConditionedMatroid(const Matroid& original,
                                        const std::vector<int>& S)
-    : s_(S.begin(), S.end()), original_(original.Clone()) {
+    : s_(ToSparseSet(S)), original_(original.Clone()) {
   Reset();
 }
 
@@ -20,13 +37,13 @@ void ConditionedMatroid::Reset() {
   for (int el : s_) {
     original_->Add(el);
   }
-  current_elements_.clear();
+  current_elements_.Clear();
 }
 
 // Return whether adding an element would be feasible.
 bool ConditionedMatroid::CanAdd(int element) const {
-  assert(!current_elements_.count(element));
-  if (s_.count(element)) {
+  assert(!current_elements_.Contains(element));
+  if (s_.Contains(element)) {
     return true;
   }
   return original_->CanAdd(element);
@@ -34,12 +51,12 @@ bool ConditionedMatroid::CanAdd(int element) const {
 
 // Return whether add element while removing anothe one would be feasible.
 bool ConditionedMatroid::CanSwap(int element, int swap) const {
-  assert(!current_elements_.count(element));
-  assert(current_elements_.count(swap));
-  if (s_.count(element)) {
+  assert(!current_elements_.Contains(element));
+  assert(current_elements_.Contains(swap));
+  if (s_.Contains(element)) {
     return true;
   }
-  if (s_.count(swap)) {
+  if (s_.Contains(swap)) {
     return original_->CanAdd(element);
   } else {
     return original_->CanSwap(element, swap);
@@ -48,18 +65,18 @@ bool ConditionedMatroid::CanSwap(int element, int swap) const {
 
 // Add an element. Assumes that the element can be added.
 void ConditionedMatroid::Add(int element) {
-  assert(!current_elements_.count(element));
-  current_elements_.insert(element);
-  if (!s_.count(element)) {
+  assert(!current_elements_.Contains(element));
+  current_elements_.Insert(element);
+  if (!s_.Contains(element)) {
     original_->Add(element);
   }
 }
 
 // Removes the element.
 void ConditionedMatroid::Remove(int element) {
-  assert(current_elements_.count(element));
-  current_elements_.erase(element);
-  if (!s_.count(element)) {
+  assert(current_elements_.Contains(element));
+  current_elements_.Erase(element);
+  if (!s_.Contains(element)) {
     original_->Remove(element);
   }
 }
@@ -68,25 +85,31 @@ void ConditionedMatroid::Remove(int element) {
 bool ConditionedMatroid::IsFeasible(const std::vector<int>& elements) const {
   std::vector<int> elements_plus_S(s_.begin(), s_.end());
   for (int el : elements) {
-    if (!s_.count(el)) {
+    if (!s_.Contains(el)) {
       elements_plus_S.push_back(el);
     }
   }
   return original_->IsFeasible(elements_plus_S);
 }
 
-// Return the current set.
-std::vector<int> ConditionedMatroid::GetCurrent() const {
-  return std::vector<int>(current_elements_.begin(), current_elements_.end());
+// Checks whether the current set is feasible. The original matroid holds S
+// together with the current elements.
+bool ConditionedMatroid::CurrentIsFeasible() const {
+  return original_->CurrentIsFeasible();
+}
+
+// Returns the current set, in no particular order.
+const std::vector<int>& ConditionedMatroid::CurrentMembers() const {
+  return current_elements_.members();
 }
 
 // Returns whether an element is in the current set.
 bool ConditionedMatroid::InCurrent(int element) const {
-  return current_elements_.count(element);
+  return current_elements_.Contains(element);
 }
 
-ConditionedMatroid::ConditionedMatroid(const std::set<int>& s,
-                                       const std::set<int>& current_elements,
+ConditionedMatroid::ConditionedMatroid(const SparseSet& s,
+                                       const SparseSet& current_elements,
                                        const Matroid& original)
     : s_(s), current_elements_(current_elements), original_(original.Clone()) {}
 
@@ -95,3 +118,16 @@ std::unique_ptr<Matroid> ConditionedMatroid::Clone() const {
   return std::unique_ptr<Matroid>(
       new ConditionedMatroid(s_, current_elements_, *original_));
 }
+
+std::unique_ptr<Matroid> MakeConditionedMatroid(const Matroid& original,
+                                                const std::vector<int>& S) {
+  const PartitionMatroid* partition =
+      dynamic_cast<const PartitionMatroid*>(&original);
+  if (partition != nullptr) {
+    std::unique_ptr<PartitionMatroid> conditioned = partition->Condition(S);
+    if (conditioned != nullptr) {
+      return conditioned;
+    }
+  }
+  return std::make_unique<ConditionedMatroid>(original, S);
+}
@@ -5,10 +5,10 @@
 #define FAIR_SUBMODULAR_MATROID_CONDITIONED_MATROID_H_
 
 #include <memory>
-#include <set>
 #include <vector>
 
 #include "matroid.h"
+#include "sparse_set.h"
 
 // This class implements a matroid M', on the *same* universe as `original`
 // matroid, such that X is independent in M' iff X u S is independent in the
@@ -39,8 +39,11 @@ class ConditionedMatroid : public Matroid {
   // Checks if a set is feasible.
   bool IsFeasible(const std::vector<int>& elements) const override;
 
-  // Return the current set.
-  std::vector<int> GetCurrent() const override;
+  // Checks whether the current set is feasible.
+  bool CurrentIsFeasible() const override;
+
+  // Returns the current set, in no particular order.
+  const std::vector<int>& CurrentMembers() const override;
 
   // Returns whether an element is in the current set.
   bool InCurrent(int element) const override;
@@ -49,18 +52,25 @@ class ConditionedMatroid : public Matroid {
   std::unique_ptr<Matroid> Clone() const override;
 
  private:
-  const std::set<int> s_;
+  const SparseSet s_;
 
   // It can intersect with S.
-  std::set<int> current_elements_;
+  SparseSet current_elements_;
 
   // It always has S, plus those current_elements that are not from S.
   std::unique_ptr<Matroid> original_;
 
   // To make Clone() work:
-  ConditionedMatroid(const std::set<int>& s,
-                     const std::set<int>& current_elements,
+  ConditionedMatroid(const SparseSet& s, const SparseSet& current_elements,
                      const Matroid& original);
 };
 
+// Returns a matroid equivalent to ConditionedMatroid(original, S). If the
+// original is a partition matroid (and S is independent in it), this is a
+// plain partition matroid with adjusted bounds (see
+// PartitionMatroid::Condition()), which avoids the indirection through the
+// original; otherwise it is a ConditionedMatroid.
+std::unique_ptr<Matroid> MakeConditionedMatroid(const Matroid& original,
+                                                const std::vector<int>& S);
+
 #endif  // FAIR_SUBMODULAR_MATROID_CONDITIONED_MATROID_H_
@@ -7,7 +7,6 @@
 #include <cassert>
 #include <map>
 #include <memory>
-#include <set>
 #include <utility>
 #include <vector>
 
@@ -21,37 +20,55 @@ FairnessConstraint::FairnessConstraint(
   bounds_ = bounds;
   ncolors_ = bounds.size();
   current_colorcounts_ = std::vector<int>(ncolors_, 0);
+  Reset();
 }
 
 void FairnessConstraint::Reset() {
   std::fill(current_colorcounts_.begin(), current_colorcounts_.end(), 0);
-  current_set_.clear();
+  num_colors_under_lower_ = 0;
+  for (const std::pair<int, int>& bound : bounds_) {
+    if (bound.first > 0) num_colors_under_lower_++;
+  }
+  num_colors_over_upper_ = 0;
+  current_set_.Clear();
 }
 
 bool FairnessConstraint::CanAdd(int element) const {
-  assert(!current_set_.count(element));
+  assert(!current_set_.Contains(element));
   int elt_color = colors_map_.at(element);
   return current_colorcounts_[elt_color] + 1 <= bounds_[elt_color].second;
 }
 
 void FairnessConstraint::Add(int element) {
-  assert(!current_set_.count(element));
+  assert(!current_set_.Contains(element));
   int elt_color = colors_map_.at(element);
   current_colorcounts_[elt_color]++;
-  current_set_.insert(element);
+  if (current_colorcounts_[elt_color] == bounds_[elt_color].first) {
+    num_colors_under_lower_--;
+  }
+  if (current_colorcounts_[elt_color] == bounds_[elt_color].second + 1) {
+    num_colors_over_upper_++;
+  }
+  current_set_.Insert(element);
 }
 
 bool FairnessConstraint::CanRemove(int element) const {
-  assert(current_set_.count(element));
+  assert(current_set_.Contains(element));
   int elt_color = colors_map_.at(element);
   return current_colorcounts_[elt_color] - 1 >= bounds_[elt_color].first;
 }
 
 void FairnessConstraint::Remove(int element) {
-  assert(current_set_.count(element));
+  assert(current_set_.Contains(element));
   int elt_color = colors_map_.at(element);
+  if (current_colorcounts_[elt_color] == bounds_[elt_color].first) {
+    num_colors_under_lower_++;
+  }
+  if (current_colorcounts_[elt_color] == bounds_[elt_color].second + 1) {
+    num_colors_over_upper_--;
+  }
   current_colorcounts_[elt_color]--;
-  current_set_.erase(element);
+  current_set_.Erase(element);
 }
 
 int FairnessConstraint::GetColor(int element) const {
@@ -78,6 +95,14 @@ bool FairnessConstraint::IsFeasible(const std::vector<int> elements) {
   return true;
 }
 
+bool FairnessConstraint::CurrentIsFeasible() const {
+  return num_colors_under_lower_ == 0 && num_colors_over_upper_ == 0;
+}
+
+bool FairnessConstraint::CurrentSatisfiesUpperBounds() const {
+  return num_colors_over_upper_ == 0;
+}
+
 std::unique_ptr<Matroid> FairnessConstraint::LowerBoundsToMatroid() const {
   std::vector<int> ks;
   ks.reserve(bounds_.size());
@@ -6,11 +6,11 @@
 
 #include <map>
 #include <memory>
-#include <set>
 #include <utility>
 #include <vector>
 
 #include "matroid.h"
+#include "sparse_set.h"
 
 class FairnessConstraint {
  public:
@@ -37,6 +37,14 @@ class FairnessConstraint {
   // Checks if a set is feasible.
   bool IsFeasible(std::vector<int> elements);
 
+  // Checks whether the current set satisfies the lower and upper bounds.
+  // Takes O(1) time.
+  bool CurrentIsFeasible() const;
+
+  // Checks whether the current set satisfies the upper bounds, i.e., is
+  // independent in UpperBoundsToMatroid(). Takes O(1) time.
+  bool CurrentSatisfiesUpperBounds() const;
+
   // Returns color of an element.
   int GetColor(int element) const;
 
@@ -66,8 +74,13 @@ class FairnessConstraint {
   // Current number of elements per color
   std::vector<int> current_colorcounts_;
 
+  // Number of colors whose current number of elements is below their lower
+  // bound, resp. above their upper bound
+  int num_colors_under_lower_;
+  int num_colors_over_upper_;
+
   // Current set
-  std::set<int> current_set_;
+  SparseSet current_set_;
 };
 
 #endif  // FAIR_SUBMODULAR_MATROID_FAIRNESS_CONSTRAINT_H_
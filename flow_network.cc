@@ -0,0 +1,83 @@
+// Copyright 2025 The Authors (see AUTHORS file)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "flow_network.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <queue>
+#include <vector>
+
+FlowNetwork::FlowNetwork(int num_nodes) : out_edges_(num_nodes) {}
+
+int FlowNetwork::AddEdge(int from, int to, int64_t capacity, int64_t flow) {
+  assert(0 <= flow && flow <= capacity);
+  const int edge = heads_.size();
+  heads_.push_back(to);
+  residual_.push_back(capacity - flow);
+  capacities_.push_back(capacity);
+  out_edges_[from].push_back(edge);
+  heads_.push_back(from);
+  residual_.push_back(flow);
+  capacities_.push_back(0);
+  out_edges_[to].push_back(edge + 1);
+  return edge;
+}
+
+int64_t FlowNetwork::GetFlow(int edge) const {
+  return capacities_[edge] - residual_[edge];
+}
+
+bool FlowNetwork::ComputeLevels(int source, int sink) {
+  levels_.assign(out_edges_.size(), -1);
+  levels_[source] = 0;
+  std::queue<int> queue;
+  queue.push(source);
+  while (!queue.empty()) {
+    const int node = queue.front();
+    queue.pop();
+    for (int edge : out_edges_[node]) {
+      if (residual_[edge] > 0 && levels_[heads_[edge]] == -1) {
+        levels_[heads_[edge]] = levels_[node] + 1;
+        queue.push(heads_[edge]);
+      }
+    }
+  }
+  return levels_[sink] != -1;
+}
+
+int64_t FlowNetwork::Push(int node, int sink, int64_t limit) {
+  if (node == sink) {
+    return limit;
+  }
+  for (int& i = next_edge_[node]; i < out_edges_[node].size(); ++i) {
+    const int edge = out_edges_[node][i];
+    const int head = heads_[edge];
+    if (residual_[edge] == 0 || levels_[head] != levels_[node] + 1) {
+      continue;
+    }
+    const int64_t pushed =
+        Push(head, sink, std::min(limit, residual_[edge]));
+    if (pushed > 0) {
+      residual_[edge] -= pushed;
+      residual_[edge ^ 1] += pushed;
+      return pushed;
+    }
+  }
+  return 0;
+}
+
+int64_t FlowNetwork::Augment(int source, int sink) {
+  int64_t total = 0;
+  while (ComputeLevels(source, sink)) {
+    next_edge_.assign(out_edges_.size(), 0);
+    while (const int64_t pushed =
+               Push(source, sink, std::numeric_limits<int64_t>::max())) {
+      total += pushed;
+    }
+  }
+  return total;
+}
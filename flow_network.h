@@ -0,0 +1,54 @@
+// Copyright 2025 The Authors (see AUTHORS file)
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef FAIR_SUBMODULAR_MATROID_FLOW_NETWORK_H_
+#define FAIR_SUBMODULAR_MATROID_FLOW_NETWORK_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+// A directed network with integer capacities and a current flow, which can
+// be augmented to a maximum flow with Dinic's algorithm. Edges may start with
+// a non-zero (feasible) flow, so that a known flow can be warm-started.
+
+class FlowNetwork {
+ public:
+  explicit FlowNetwork(int num_nodes);
+
+  // Adds an edge from -> to with the given capacity and initial flow
+  // (0 <= flow <= capacity). Returns the id of the edge.
+  int AddEdge(int from, int to, int64_t capacity, int64_t flow = 0);
+
+  // Augments the current flow to a maximum source-sink flow. Returns by how
+  // much the flow value increased. Augmenting paths never leave the sink or
+  // re-enter the source, so the flow through any other node is unchanged.
+  int64_t Augment(int source, int sink);
+
+  // Returns the current flow on an edge.
+  int64_t GetFlow(int edge) const;
+
+ private:
+  // Computes BFS levels in the residual network; returns whether the sink is
+  // reachable.
+  bool ComputeLevels(int source, int sink);
+
+  // Pushes at most `limit` units from node to the sink along the level
+  // graph; returns how much was pushed.
+  int64_t Push(int node, int sink, int64_t limit);
+
+  // Edges are stored in pairs: edge 2i is the i-th added edge and 2i + 1 its
+  // reverse. residual_[e] is the remaining capacity of e.
+  std::vector<int> heads_;
+  std::vector<int64_t> residual_;
+  std::vector<int64_t> capacities_;
+
+  // out_edges_[v] = edges (including reverse ones) leaving v.
+  std::vector<std::vector<int>> out_edges_;
+
+  // Scratch state of Augment().
+  std::vector<int> levels_;
+  std::vector<int> next_edge_;
+};
+
+#endif  // FAIR_SUBMODULAR_MATROID_FLOW_NETWORK_H_
@@ -6,24 +6,401 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <functional>
 #include <iostream>
 #include <map>
-#include <set>
+#include <memory>
 #include <string>
+#include <system_error>
 #include <utility>
 #include <vector>
 
+#include "mapped_file.h"
 #include "utilities.h"
 
-struct hash_pair {
-  size_t operator()(const std::pair<int, int>& p) const {
-    return std::hash<int>{}(p.first) ^ std::hash<int>{}(p.second);
+namespace {
+
+// Binary graph files consist of this header followed by these arrays, each
+// starting at a multiple of 8 bytes:
+//   int64_t offsets[num_vertices + 1]   (CSR row offsets into adjacency)
+//   int32_t adjacency[num_edges]
+//   int32_t left_vertices[num_left]
+//   int32_t right_vertices[num_right]
+//   int32_t vertex_colors[num_vertices] (-1 if a vertex has no color)
+//   int32_t vertex_groups[num_vertices] (-1 if a vertex has no group)
+//   int32_t colors_cards[num_colors]
+//   int32_t groups_cards[num_groups]
+// Vertices are already renumbered. Integers are stored in native byte order.
+struct GraphFileHeader {
+  char magic[8];
+  int64_t num_vertices;
+  int64_t num_edges;
+  int64_t num_left;
+  int64_t num_right;
+  int64_t num_colors;
+  int64_t num_groups;
+  // Sizes and modification times of the edge, color and group text files
+  // that the binary file was built from.
+  int64_t source_sizes[3];
+  int64_t source_mtimes[3];
+};
+
+constexpr char kGraphFileMagic[8] = {'F', 'S', 'M', 'G', 'R', 'P', 'H', '1'};
+
+int64_t Align8(int64_t bytes) { return (bytes + 7) / 8 * 8; }
+
+// Byte offsets of the arrays in a binary graph file.
+struct GraphFileLayout {
+  explicit GraphFileLayout(const GraphFileHeader& header) {
+    offsets = Align8(sizeof(GraphFileHeader));
+    adjacency = offsets + (header.num_vertices + 1) * sizeof(int64_t);
+    left_vertices = Align8(adjacency + header.num_edges * sizeof(int32_t));
+    right_vertices =
+        Align8(left_vertices + header.num_left * sizeof(int32_t));
+    vertex_colors =
+        Align8(right_vertices + header.num_right * sizeof(int32_t));
+    vertex_groups =
+        Align8(vertex_colors + header.num_vertices * sizeof(int32_t));
+    colors_cards =
+        Align8(vertex_groups + header.num_vertices * sizeof(int32_t));
+    groups_cards = Align8(colors_cards + header.num_colors * sizeof(int32_t));
+    total = Align8(groups_cards + header.num_groups * sizeof(int32_t));
   }
+
+  int64_t offsets, adjacency, left_vertices, right_vertices, vertex_colors,
+      vertex_groups, colors_cards, groups_cards, total;
 };
 
-Graph::Graph(const std::string& name) : name_(name) {
+// Gets the size and modification time of a file. Returns false if the file
+// does not exist.
+bool GetFileStamp(const std::string& file_name, int64_t* size,
+                  int64_t* mtime) {
+  std::error_code error;
+  *size = std::filesystem::file_size(file_name, error);
+  if (error) return false;
+  *mtime = std::filesystem::last_write_time(file_name, error)
+               .time_since_epoch()
+               .count();
+  return !error;
+}
+
+// Returns whether `image` is a binary graph file built from the current
+// versions of `file_names` (text files that no longer exist are not checked).
+bool IsUpToDate(const MappedFile& image,
+                const std::vector<std::string>& file_names) {
+  if (image.size() < sizeof(GraphFileHeader)) return false;
+  const auto& header = *reinterpret_cast<const GraphFileHeader*>(image.data());
+  if (std::memcmp(header.magic, kGraphFileMagic, sizeof(kGraphFileMagic))) {
+    return false;
+  }
+  if (image.size() < GraphFileLayout(header).total) return false;
+  for (int i = 0; i < 3; ++i) {
+    int64_t size, mtime;
+    if (GetFileStamp(file_names[i], &size, &mtime) &&
+        (size != header.source_sizes[i] || mtime != header.source_mtimes[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T>
+void CopyToImage(const std::vector<T>& values, int64_t offset,
+                 std::vector<char>* image) {
+  if (!values.empty()) {
+    std::memcpy(image->data() + offset, values.data(),
+                values.size() * sizeof(T));
+  }
+}
+
+// Number of byte ranges per thread that text files are split into.
+constexpr int kParseChunksPerThread = 4;
+
+bool IsSpace(char c) {
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' ||
+         c == '\f';
+}
+
+// Reads all whitespace-separated integers of a text file, like repeated
+// `input >> x` would: reading stops at the first token that is not an
+// integer. The file is split into byte ranges that are scanned in parallel.
+std::vector<int64_t> ReadIntegers(const MappedFile& file) {
+  const char* const data = file.data();
+  const int64_t size = file.size();
+  const int num_chunks = std::max<int64_t>(
+      1, std::min<int64_t>(NumThreads() * kParseChunksPerThread, size / 4096));
+  // Chunks start at token boundaries (a token belongs to the chunk in which
+  // it starts).
+  std::vector<int64_t> starts(num_chunks + 1, size);
+  for (int i = 0; i < num_chunks; ++i) {
+    int64_t start = std::max(size * i / num_chunks, i > 0 ? starts[i - 1] : 0);
+    while (start > 0 && start < size && !IsSpace(data[start - 1])) ++start;
+    starts[i] = start;
+  }
+  std::vector<std::vector<int64_t>> chunk_values(num_chunks);
+  std::vector<char> chunk_stopped(num_chunks, false);
+  ParallelFor(num_chunks, [&](int i) {
+    std::vector<int64_t>& values = chunk_values[i];
+    const char* p = data + starts[i];
+    const char* const end = data + starts[i + 1];
+    while (true) {
+      while (p < end && IsSpace(*p)) ++p;
+      if (p == end) break;
+      const bool negative = *p == '-';
+      if (*p == '-' || *p == '+') ++p;
+      const char* const digits = p;
+      int64_t value = 0;
+      while (p < end && '0' <= *p && *p <= '9') {
+        value = value * 10 + (*p - '0');
+        ++p;
+      }
+      if (p == digits) {
+        chunk_stopped[i] = true;
+        break;
+      }
+      values.push_back(negative ? -value : value);
+      // Anything glued to the number makes the next read fail.
+      if (p < end && !IsSpace(*p)) {
+        chunk_stopped[i] = true;
+        break;
+      }
+    }
+  });
+  std::vector<int64_t> values;
+  for (int i = 0; i < num_chunks; ++i) {
+    values.insert(values.end(), chunk_values[i].begin(),
+                  chunk_values[i].end());
+    if (chunk_stopped[i]) break;
+  }
+  return values;
+}
+
+// Reads the pairs of integers of a text file (as `input >> x >> y` would).
+std::vector<int64_t> ReadPairs(const std::string& file_name,
+                               const std::string& missing_file_error) {
+  std::unique_ptr<MappedFile> file = MappedFile::Open(file_name, false);
+  if (!file) Fail(missing_file_error);
+  std::vector<int64_t> values = ReadIntegers(*file);
+  values.resize(values.size() / 2 * 2);
+  return values;
+}
+
+// Renumbers the vertex ids of an edge list 0, 1, ... in the order of their
+// first appearance. Original ids are sorted (in parallel) together with their
+// positions, rather than going through a hash map.
+class Renumbering {
+ public:
+  // Replaces every element of `endpoints` by its new id.
+  explicit Renumbering(std::vector<int64_t>& endpoints) {
+    std::vector<std::pair<int64_t, int64_t>> occurrences(endpoints.size());
+    ParallelFor(endpoints.size() / kBlock + 1, [&](int block) {
+      const int64_t end = std::min<int64_t>(endpoints.size(),
+                                            (block + 1) * kBlock);
+      for (int64_t p = block * kBlock; p < end; ++p) {
+        occurrences[p] = {endpoints[p], p};
+      }
+    });
+    ParallelSort(occurrences, std::less<std::pair<int64_t, int64_t>>());
+
+    // Distinct ids in sorted order, with their first positions; the
+    // endpoints temporarily hold indices into sorted_ids_.
+    std::vector<std::pair<int64_t, int>> first_positions;
+    for (const std::pair<int64_t, int64_t>& occurrence : occurrences) {
+      if (sorted_ids_.empty() || sorted_ids_.back() != occurrence.first) {
+        first_positions.emplace_back(occurrence.second, sorted_ids_.size());
+        sorted_ids_.push_back(occurrence.first);
+      }
+      endpoints[occurrence.second] = sorted_ids_.size() - 1;
+    }
+    ParallelSort(first_positions, std::less<std::pair<int64_t, int>>());
+    new_ids_.resize(sorted_ids_.size());
+    for (int new_id = 0; new_id < first_positions.size(); ++new_id) {
+      new_ids_[first_positions[new_id].second] = new_id;
+    }
+    ParallelFor(endpoints.size() / kBlock + 1, [&](int block) {
+      const int64_t end = std::min<int64_t>(endpoints.size(),
+                                            (block + 1) * kBlock);
+      for (int64_t p = block * kBlock; p < end; ++p) {
+        endpoints[p] = new_ids_[endpoints[p]];
+      }
+    });
+  }
+
+  // Returns the number of distinct vertices.
+  int NumVertices() const { return sorted_ids_.size(); }
+
+  // Returns the new id of an original id, or -1 if it does not occur.
+  int Lookup(int64_t id) const {
+    auto it = std::lower_bound(sorted_ids_.begin(), sorted_ids_.end(), id);
+    if (it == sorted_ids_.end() || *it != id) return -1;
+    return new_ids_[it - sorted_ids_.begin()];
+  }
+
+ private:
+  // Number of elements handled by one ParallelFor iteration.
+  static constexpr int64_t kBlock = 1 << 16;
+
+  // Distinct original ids, sorted.
+  std::vector<int64_t> sorted_ids_;
+  // new_ids_[i] = new id of sorted_ids_[i].
+  std::vector<int> new_ids_;
+};
+
+// Returns the sorted distinct elements of `values`.
+std::vector<int32_t> SortedDistinct(std::vector<int32_t> values) {
+  ParallelSort(values, std::less<int32_t>());
+  values.erase(std::unique(values.begin(), values.end()), values.end());
+  return values;
+}
+
+// Reads the edge, color and group text files and returns the graph in the
+// binary format.
+std::vector<char> BuildImageFromText(
+    const std::vector<std::string>& file_names) {
+  const std::string& file_name = file_names[0];
+  std::cerr << "reading graph from " << file_name << " ..." << std::endl;
+  // endpoints[2 * i] -> endpoints[2 * i + 1] is the i-th edge.
+  // Note: our graphs are directed.
+  // But in some cases you may want to also add the reverse edge.
+  std::vector<int64_t> endpoints = ReadPairs(
+      file_name,
+      "Graph file does not exist. Please refer to README on how to download the datasets.");
+  const int64_t num_edges = endpoints.size() / 2;
+  const Renumbering renumber(endpoints);
+  const int num_vertices = renumber.NumVertices();
+
+  std::vector<int32_t> sources(num_edges), targets(num_edges);
+  for (int64_t i = 0; i < num_edges; ++i) {
+    sources[i] = endpoints[2 * i];
+    targets[i] = endpoints[2 * i + 1];
+  }
+  endpoints = std::vector<int64_t>();
+  const std::vector<int32_t> left_vertices = SortedDistinct(sources);
+  const std::vector<int32_t> right_vertices = SortedDistinct(targets);
+  std::vector<char> is_left(num_vertices, false);
+  for (int v : left_vertices) is_left[v] = true;
+
+  // Bucket the edges by source, keeping their order within each bucket.
+  std::vector<int64_t> offsets(num_vertices + 1, 0);
+  for (int source : sources) {
+    ++offsets[source + 1];
+  }
+  for (int v = 0; v < num_vertices; ++v) {
+    offsets[v + 1] += offsets[v];
+  }
+  std::vector<int32_t> adjacency(num_edges);
+  {
+    std::vector<int64_t> next(offsets.begin(), offsets.end() - 1);
+    for (int64_t i = 0; i < num_edges; ++i) {
+      adjacency[next[sources[i]]++] = targets[i];
+    }
+  }
+
+  // Reads a file of (vertex, label) pairs; labels are renumbered in order of
+  // first appearance and counted only over elements of V.
+  auto read_labels = [&](const std::string& labels_file_name,
+                         const std::string& missing_file_error,
+                         std::vector<int32_t>* vertex_labels,
+                         std::vector<int32_t>* cards) {
+    const std::vector<int64_t> pairs =
+        ReadPairs(labels_file_name, missing_file_error);
+    const int64_t num_pairs = pairs.size() / 2;
+    std::vector<int> vertices(num_pairs);
+    ParallelFor(NumThreads(), [&](int t) {
+      for (int64_t i = num_pairs * t / NumThreads();
+           i < num_pairs * (t + 1) / NumThreads(); ++i) {
+        vertices[i] = renumber.Lookup(pairs[2 * i]);
+      }
+    });
+    vertex_labels->assign(num_vertices, -1);
+    bool printed_this_already = false;
+    std::map<int64_t, int> renumber_label;
+    for (int64_t i = 0; i < num_pairs; ++i) {
+      const int64_t label = pairs[2 * i + 1];
+      auto it = renumber_label.find(label);
+      if (it == renumber_label.end()) {
+        it = renumber_label.emplace(label, renumber_label.size()).first;
+        cards->push_back(0);
+      }
+
+      if (vertices[i] == -1) {
+        if (!printed_this_already) {
+          std::cerr << "It seems that vertex " << pairs[2 * i]
+                  << " from " << labels_file_name << " does not exist in the graph."
+                  << " (Maybe it just means there are vertices with 0 in- or out-degree)" << std::endl;
+          printed_this_already = true;
+        }
+      } else {
+        (*vertex_labels)[vertices[i]] = it->second;
+        if (is_left[vertices[i]])
+          // only count elements in V
+          (*cards)[it->second]++;
+      }
+    }
+  };
+
+  std::cerr << "reading colors from " << file_names[1] << " ..." << std::endl;
+  std::vector<int32_t> vertex_colors, colors_cards;
+  read_labels(file_names[1], "Color file does not exist.", &vertex_colors,
+              &colors_cards);
+  std::cerr << "reading groups from " << file_names[2] << " ..." << std::endl;
+  std::vector<int32_t> vertex_groups, groups_cards;
+  read_labels(file_names[2], "Group file does not exist.", &vertex_groups,
+              &groups_cards);
+
+  GraphFileHeader header = {};
+  std::memcpy(header.magic, kGraphFileMagic, sizeof(kGraphFileMagic));
+  header.num_vertices = num_vertices;
+  header.num_edges = num_edges;
+  header.num_left = left_vertices.size();
+  header.num_right = right_vertices.size();
+  header.num_colors = colors_cards.size();
+  header.num_groups = groups_cards.size();
+  for (int i = 0; i < 3; ++i) {
+    GetFileStamp(file_names[i], &header.source_sizes[i],
+                 &header.source_mtimes[i]);
+  }
+  const GraphFileLayout layout(header);
+  std::vector<char> image(layout.total, 0);
+  std::memcpy(image.data(), &header, sizeof(header));
+  CopyToImage(offsets, layout.offsets, &image);
+  CopyToImage(adjacency, layout.adjacency, &image);
+  CopyToImage(left_vertices, layout.left_vertices, &image);
+  CopyToImage(right_vertices, layout.right_vertices, &image);
+  CopyToImage(vertex_colors, layout.vertex_colors, &image);
+  CopyToImage(vertex_groups, layout.vertex_groups, &image);
+  CopyToImage(colors_cards, layout.colors_cards, &image);
+  CopyToImage(groups_cards, layout.groups_cards, &image);
+  return image;
+}
+
+// Writes the binary graph file (via a temporary file, so that an interrupted
+// run does not leave a truncated one behind).
+void WriteImage(const std::vector<char>& image,
+                const std::string& binary_file_name) {
+  const std::string temp_file_name = binary_file_name + ".tmp";
+  {
+    std::ofstream output(temp_file_name, std::ios::binary);
+    output.write(image.data(), image.size());
+    if (!output) {
+      std::cerr << "could not write " << temp_file_name << std::endl;
+      return;
+    }
+  }
+  if (std::rename(temp_file_name.c_str(), binary_file_name.c_str()) != 0) {
+    std::cerr << "could not write " << binary_file_name << std::endl;
+    std::remove(temp_file_name.c_str());
+  }
+}
+
+}  // namespace
+
+Graph::Graph(const std::string& name, bool use_huge_pages) : name_(name) {
   // Technical comment: would prefer to make this constructor private,
   // but this breaks a crucial line in getGraph.
 
@@ -41,109 +418,21 @@ Graph::Graph(const std::string& name) : name_(name) {
   if (!name_to_filename->count(name_)) {
     Fail("unknown graph name");
   }
-  const std::string& file_name = name_to_filename->at(name_)[0];
-
-  std::cerr << "reading graph from " << file_name << " ..." << std::endl;
-  std::ifstream input(file_name);
-  if (!input) {
-    Fail("Graph file does not exist. Please refer to README on how to download the datasets.");
-  }
-  // renumber[x] = new number of x
-  std::unordered_map<int64_t, int> renumber;
-  num_vertices_ = 0;
-  num_edges_ = 0;
-  int64_t first_endpoint, second_endpoint;
-  std::set<int> left_vertices, right_vertices;
-  while (input >> first_endpoint >> second_endpoint) {
-    if (!renumber.count(first_endpoint)) {
-      renumber[first_endpoint] = num_vertices_;
-      ++num_vertices_;
-      neighbors_.push_back({});
-    }
-    left_vertices.insert(renumber[first_endpoint]);
-    if (!renumber.count(second_endpoint)) {
-      renumber[second_endpoint] = num_vertices_;
-      ++num_vertices_;
-      neighbors_.push_back({});
-    }
-    right_vertices.insert(renumber[second_endpoint]);
-    num_edges_++;
-    neighbors_[renumber[first_endpoint]].push_back(renumber[second_endpoint]);
-    // Note: our graphs are directed.
-    // But in some cases you may want to also add the reverse edge.
-  }
-  left_vertices_.assign(left_vertices.begin(), left_vertices.end());
-  right_vertices_.assign(right_vertices.begin(), right_vertices.end());
-
-  const std::string& file_name_colors = name_to_filename->at(name_)[1];
-  std::cerr << "reading colors from " << file_name_colors << " ..."
-            << std::endl;
-  std::ifstream input_colors(file_name_colors);
-  if (!input_colors) Fail("Color file does not exist.");
-
-  int vertex, color;
-  std::map<int, int> renumber_color;
-  num_colors_ = 0;
-  colors_map_.clear();
-  while (input_colors >> vertex >> color) {
-    if (!renumber_color.count(color)) {
-      renumber_color[color] = num_colors_;
-      num_colors_++;
-      colors_cards_.push_back(0);
-    }
-
-    if (!renumber.count(vertex)) {
-      static bool printed_this_already = false;
-      if (!printed_this_already) {
-        std::cerr << "It seems that vertex " << vertex
-                << " from " << file_name_colors << " does not exist in the graph."
-                << " (Maybe it just means there are vertices with 0 in- or out-degree)" << std::endl;
-        printed_this_already = true;
-      }
-    } else {
-      colors_map_[renumber[vertex]] = renumber_color[color];
-      if (left_vertices.count(renumber[vertex]))
-        // only count elements in V
-        colors_cards_[renumber_color[color]]++;
-    }
-  }
-
-  const std::string& file_name_groups = name_to_filename->at(name_)[2];
-  std::cerr << "reading groups from " << file_name_groups << " ..."
-            << std::endl;
-  std::ifstream input_groups(file_name_groups);
-  if (!input_groups) Fail("Group file does not exist.");
-
-  int group;
-  std::map<int, int> renumber_group;
-  num_groups_ = 0;
-  groups_map_.clear();
-
-  while (input_groups >> vertex >> group) {
-    if (!renumber_group.count(group)) {
-      renumber_group[group] = num_groups_;
-      num_groups_++;
-      groups_cards_.push_back(0);
-    }
+  const std::vector<std::string>& file_names = name_to_filename->at(name_);
+  const std::string binary_file_name = file_names[0] + ".csr";
 
-    if (!renumber.count(vertex)) {
-      static bool printed_this_already = false;
-      if (!printed_this_already) {
-        std::cerr << "It seems that vertex " << vertex
-                << " from " << file_name_groups << " does not exist in the graph."
-                << " (Maybe it just means there are vertices with 0 in- or out-degree)" << std::endl;
-        printed_this_already = true;
-      }
-    } else {
-      groups_map_[renumber[vertex]] = renumber_group[group];
-      if (left_vertices.count(renumber[vertex]))
-        // only count elements in V
-        groups_cards_[renumber_group[group]]++;
-    }
+  image_ = MappedFile::Open(binary_file_name, use_huge_pages);
+  if (image_ && IsUpToDate(*image_, file_names)) {
+    std::cerr << "reading graph from " << binary_file_name << std::endl;
+  } else {
+    std::vector<char> image = BuildImageFromText(file_names);
+    WriteImage(image, binary_file_name);
+    image_ = MappedFile::FromBuffer(std::move(image));
   }
+  LoadFromImage();
 
   std::cerr << "read graph with " << num_vertices_ << " vertices (of which "
-            << left_vertices.size() << " are in V) and " << num_edges_
+            << left_vertices_.size() << " are in V) and " << num_edges_
             << " edges" << std::endl;
   std::cerr << "# of vertices with colors " << colors_map_.size() << std::endl;
   std::cerr << "# of vertices with groups " << groups_map_.size() << std::endl;
@@ -161,6 +450,45 @@ Graph::Graph(const std::string& name) : name_(name) {
   std::cout << std::endl;
 }
 
+void Graph::LoadFromImage() {
+  const char* data = image_->data();
+  const auto& header = *reinterpret_cast<const GraphFileHeader*>(data);
+  const GraphFileLayout layout(header);
+  num_vertices_ = header.num_vertices;
+  num_edges_ = header.num_edges;
+  num_colors_ = header.num_colors;
+  num_groups_ = header.num_groups;
+
+  offsets_ = reinterpret_cast<const int64_t*>(data + layout.offsets);
+  adjacency_ = reinterpret_cast<const int*>(data + layout.adjacency);
+
+  auto ints = [data](int64_t offset) {
+    return reinterpret_cast<const int32_t*>(data + offset);
+  };
+  left_vertices_.assign(ints(layout.left_vertices),
+                        ints(layout.left_vertices) + header.num_left);
+  right_vertices_.assign(ints(layout.right_vertices),
+                         ints(layout.right_vertices) + header.num_right);
+  colors_cards_.assign(ints(layout.colors_cards),
+                       ints(layout.colors_cards) + num_colors_);
+  groups_cards_.assign(ints(layout.groups_cards),
+                       ints(layout.groups_cards) + num_groups_);
+
+  const int32_t* vertex_colors = ints(layout.vertex_colors);
+  const int32_t* vertex_groups = ints(layout.vertex_groups);
+  colors_map_.clear();
+  groups_map_.clear();
+  for (int v = 0; v < num_vertices_; ++v) {
+    // Vertices come in increasing order, so the hint makes this linear.
+    if (vertex_colors[v] >= 0) {
+      colors_map_.emplace_hint(colors_map_.end(), v, vertex_colors[v]);
+    }
+    if (vertex_groups[v] >= 0) {
+      groups_map_.emplace_hint(groups_map_.end(), v, vertex_groups[v]);
+    }
+  }
+}
+
 const std::vector<int>& Graph::GetCoverableVertices() const {
   return right_vertices_;
 }
@@ -169,8 +497,9 @@ const std::vector<int>& Graph::GetUniverseVertices() const {
   return left_vertices_;
 }
 
-const std::vector<int>& Graph::GetNeighbors(int vertex_i) const {
-  return neighbors_[vertex_i];
+Graph::Neighbors Graph::GetNeighbors(int vertex_i) const {
+  return Neighbors(adjacency_ + offsets_[vertex_i],
+                   adjacency_ + offsets_[vertex_i + 1]);
 }
 
 const std::string& Graph::GetName() const { return name_; }
@@ -7,25 +7,48 @@
 #include <stdint.h>
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "mapped_file.h"
+
+// The adjacency is stored in compressed sparse row (CSR) form. After the
+// first load from the text files, the graph is also saved in a binary format
+// (see graph.cc) next to the edge file, which later runs map directly.
 
 class Graph {
  public:
+  // A contiguous list of neighbors, usable in range-based for loops.
+  class Neighbors {
+   public:
+    Neighbors(const int* begin, const int* end) : begin_(begin), end_(end) {}
+    const int* begin() const { return begin_; }
+    const int* end() const { return end_; }
+    int size() const { return end_ - begin_; }
+
+   private:
+    const int* begin_;
+    const int* end_;
+  };
+
   // Forbids copying.
   Graph(const Graph&) = delete;
   Graph& operator=(const Graph&) = delete;
   // Allow moving.
   Graph(Graph&&) = default;
 
-  explicit Graph(const std::string& name);
+  // If use_huge_pages is set, the binary file is mapped with a hint to use
+  // huge pages.
+  explicit Graph(const std::string& name, bool use_huge_pages = false);
 
-  // Returns the graph.
-  static Graph& GetGraph(const std::string& name) {
+  // Returns the graph. use_huge_pages only applies when the graph is first
+  // loaded.
+  static Graph& GetGraph(const std::string& name,
+                         bool use_huge_pages = false) {
     static auto* const name_to_graph = new std::map<std::string, Graph>();
     if (!name_to_graph->count(name)) {
-      name_to_graph->emplace(name, Graph(name));
+      name_to_graph->emplace(name, Graph(name, use_huge_pages));
     }
     return name_to_graph->at(name);
   }
@@ -37,7 +60,7 @@ class Graph {
   const std::vector<int>& GetUniverseVertices() const;
 
   // Returns the list of neighbors of a vertex.
-  const std::vector<int>& GetNeighbors(int vertex_i) const;
+  Neighbors GetNeighbors(int vertex_i) const;
 
   // Returns the name of the graph.
   const std::string& GetName() const;
@@ -55,6 +78,9 @@ class Graph {
   const std::map<int, int>& GetGroupsMap() const;
 
  private:
+  // Points the fields below at the contents of image_.
+  void LoadFromImage();
+
   // Name of dataset.
   const std::string name_;
   // Number of edges in the graph.
@@ -75,8 +101,13 @@ class Graph {
   // Map from vertices to groups.
   std::map<int, int> groups_map_;
 
-  // Neighbors[i] = list of i's neighbors.
-  std::vector<std::vector<int>> neighbors_;
+  // The graph in the binary format; offsets_ and adjacency_ point into it.
+  std::unique_ptr<MappedFile> image_;
+
+  // The neighbors of i are adjacency_[offsets_[i]], ...,
+  // adjacency_[offsets_[i + 1] - 1].
+  const int64_t* offsets_ = nullptr;
+  const int* adjacency_ = nullptr;
 
   // Those that have an edge out of them (the universe of f).
   std::vector<int> left_vertices_;
@@ -4,11 +4,12 @@
 #include "graph_utility.h"
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include <algorithm>
 #include <cassert>
+#include <limits>
 #include <memory>
-#include <set>
 #include <string>
 #include <vector>
 
@@ -26,12 +27,15 @@ GraphUtility::GraphUtility(Graph& graph) : graph_(graph) {
     Fail("looks like vertices were not renumbered?");
   }
   present_elements_.assign(max_el + 1, 0);
-  existing_elements_.clear();
+  covered_epoch_.assign(max_el + 1, 0);
+  const std::vector<int>& universe = graph_.GetUniverseVertices();
+  in_solution_.assign(*std::max_element(universe.begin(), universe.end()) + 1,
+                      false);
 }
 
 void GraphUtility::Reset() {
   present_elements_.assign(present_elements_.size(), 0);
-  existing_elements_.clear();
+  in_solution_.assign(in_solution_.size(), false);
 }
 
 double GraphUtility::Delta(int element) {
@@ -44,22 +48,36 @@ double GraphUtility::Delta(int element) {
   return val;
 }
 
+void GraphUtility::DeltaBatch(const std::vector<int>& elements,
+                              std::vector<double>* deltas) {
+  const int* present = present_elements_.data();
+  for (int i = 0; i < elements.size(); ++i) {
+    int val = 0;
+    for (int x : graph_.GetNeighbors(elements[i])) {
+      val += !present[x];
+    }
+    (*deltas)[i] = val;
+  }
+}
+
 void GraphUtility::Add(int element) {
-  existing_elements_.insert(element);
+  assert(!in_solution_[element]);
+  in_solution_[element] = true;
   for (int x : graph_.GetNeighbors(element)) {
     present_elements_[x]++;
   }
 }
 
 void GraphUtility::Remove(int element) {
-  assert(existing_elements_.erase(element) == 1);
+  assert(in_solution_[element]);
+  in_solution_[element] = false;
   for (int x : graph_.GetNeighbors(element)) {
     present_elements_[x]--;
   }
 }
 
 double GraphUtility::RemovalDelta(int element) {
-  assert(existing_elements_.count(element));
+  assert(in_solution_[element]);
 
   int val = 0;
   for (int x : graph_.GetNeighbors(element)) {
@@ -72,7 +90,8 @@ double GraphUtility::RemovalDelta(int element) {
 double GraphUtility::RemoveAndIncreaseOracleCall(int element) {
   ++oracle_calls_;
 
-  assert(existing_elements_.erase(element) == 1);
+  assert(in_solution_[element]);
+  in_solution_[element] = false;
 
   int val = 0;
   for (int x : graph_.GetNeighbors(element)) {
@@ -83,14 +102,22 @@ double GraphUtility::RemoveAndIncreaseOracleCall(int element) {
 }
 
 double GraphUtility::Objective(const std::vector<int>& elements) const {
-  std::set<int> covered_vertices;
+  if (objective_epoch_ == std::numeric_limits<int>::max()) {
+    covered_epoch_.assign(covered_epoch_.size(), 0);
+    objective_epoch_ = 0;
+  }
+  const int epoch = ++objective_epoch_;
+  int64_t covered_vertices = 0;
   for (const int it : elements) {
     for (int x : graph_.GetNeighbors(it)) {
-      covered_vertices.insert(x);
+      if (covered_epoch_[x] != epoch) {
+        covered_epoch_[x] = epoch;
+        ++covered_vertices;
+      }
     }
   }
 
-  return covered_vertices.size();
+  return covered_vertices;
 }
 
 const std::vector<int>& GraphUtility::GetUniverse() const {
@@ -5,7 +5,6 @@
 #define FAIR_SUBMODULAR_MATROID_GRAPH_UTILITY_H_
 
 #include <memory>
-#include <set>
 #include <string>
 #include <vector>
 
@@ -41,7 +40,13 @@ class GraphUtility : public SubmodularFunction {
   // Computes f(S u {e}) - f(S).
   double Delta(int element) override;
 
+  // Computes f(S u {e}) - f(S) for a batch of elements.
+  void DeltaBatch(const std::vector<int>& elements,
+                  std::vector<double>* deltas) override;
+
   // Returns the value of the given elements.
+  // Uses scratch space of the object, so it is not safe to call concurrently
+  // on the same object.
   double Objective(const std::vector<int>& elements) const override;
 
   // Computes f(S) - f(S - e).
@@ -52,11 +57,17 @@ class GraphUtility : public SubmodularFunction {
   // The underlying graph.
   const Graph& graph_;
 
+  // Counts how many elements in current solution cover each element.
   // Can also implement with unordered_map, might be faster sometimes.
-  std::vector<int> present_elements_;  // elements in current solution
+  std::vector<int> present_elements_;
+
+  // Membership bitmap of the current solution, indexed by vertex.
+  std::vector<bool> in_solution_;
 
-  // Counts how many element in current solution cover each element
-  std::set<int> existing_elements_;
+  // Scratch space for Objective(): a vertex counts as covered in the current
+  // call iff its stamp equals objective_epoch_.
+  mutable std::vector<int> covered_epoch_;
+  mutable int objective_epoch_ = 0;
 };
 
 #endif  // FAIR_SUBMODULAR_MATROID_GRAPH_UTILITY_H_
@@ -10,71 +10,168 @@
 #include <utility>
 #include <vector>
 
+#include "utilities.h"
+
 LaminarMatroid::LaminarMatroid(
     const std::map<int, std::vector<int>>& groups_map,
     const std::vector<int>& ks)
-    : groups_map_(groups_map),
-      ks_(ks),
+    : ks_(ks),
       num_groups_(ks.size()),
-      current_grpcards_(num_groups_, 0) {
-  // Assume groups are laminar.
+      parent_(num_groups_ + 1, -2),
+      entry_(num_groups_ + 1),
+      exit_(num_groups_ + 1),
+      current_grpcards_(num_groups_, 0),
+      node_members_(num_groups_ + 1) {
+  const int root = num_groups_;
+  parent_[root] = -1;
+  if (!groups_map.empty()) {
+    if (groups_map.begin()->first < 0) {
+      Fail("laminar matroid elements must be non-negative");
+    }
+    nodes_.assign(groups_map.rbegin()->first + 1, -1);
+  }
+  std::vector<int> sizes(num_groups_, 0);
+  for (const auto& [element, groups] : groups_map) {
+    for (int group : groups) {
+      if (group < 0 || group >= num_groups_) {
+        Fail("laminar matroid group out of range");
+      }
+      sizes[group]++;
+    }
+  }
+  // The groups of an element, from largest to smallest, form a path from the
+  // root. In a laminar family every element gives the same parents.
+  std::vector<int> chain;
+  for (const auto& [element, groups] : groups_map) {
+    chain = groups;
+    std::sort(chain.begin(), chain.end(), [&sizes](int a, int b) {
+      return sizes[a] != sizes[b] ? sizes[a] > sizes[b] : a < b;
+    });
+    chain.erase(std::unique(chain.begin(), chain.end()), chain.end());
+    int parent = root;
+    for (int group : chain) {
+      if (parent_[group] == -2) {
+        parent_[group] = parent;
+      } else if (parent_[group] != parent) {
+        Fail("laminar matroid groups are not laminar");
+      }
+      parent = group;
+    }
+    nodes_[element] = parent;
+  }
+
+  std::vector<std::vector<int>> children(num_groups_ + 1);
+  for (int group = 0; group < num_groups_; ++group) {
+    if (parent_[group] == -2) {
+      // Group without elements.
+      parent_[group] = root;
+    }
+    children[parent_[group]].push_back(group);
+  }
+  // Iterative DFS; each stack entry is a node and its next child to visit.
+  std::vector<std::pair<int, int>> stack = {{root, 0}};
+  entry_[root] = 0;
+  preorder_.push_back(root);
+  while (!stack.empty()) {
+    const int node = stack.back().first;
+    const int next_child = stack.back().second++;
+    if (next_child < children[node].size()) {
+      const int child = children[node][next_child];
+      entry_[child] = preorder_.size();
+      preorder_.push_back(child);
+      stack.emplace_back(child, 0);
+    } else {
+      exit_[node] = preorder_.size();
+      stack.pop_back();
+    }
+  }
 }
 
 void LaminarMatroid::Reset() {
   std::fill(current_grpcards_.begin(), current_grpcards_.end(), 0);
-  current_set_.clear();
+  for (std::vector<int>& members : node_members_) {
+    members.clear();
+  }
+  num_groups_over_bound_ = 0;
+  current_set_.Clear();
 }
 
-bool LaminarMatroid::CanAdd(int element) const {
-  assert(!current_set_.count(element));
-  const std::vector<int>& elt_groups = groups_map_.at(element);
-  for (int elt_group : elt_groups) {
-    if (current_grpcards_[elt_group] + 1 > ks_[elt_group]) return false;
+int LaminarMatroid::LowestTightAncestor(int node) const {
+  for (int group = node; group != num_groups_; group = parent_[group]) {
+    if (current_grpcards_[group] >= ks_[group]) {
+      return group;
+    }
   }
-  return true;
+  return -1;
+}
+
+bool LaminarMatroid::CanAdd(int element) const {
+  assert(!current_set_.Contains(element));
+  return LowestTightAncestor(NodeOf(element)) == -1;
 }
 
 bool LaminarMatroid::CanSwap(int element, int swap) const {
-  assert(!current_set_.count(element));
-  assert(current_set_.count(swap));
-  const std::vector<int>& elt_groups = groups_map_.at(element);
-  const std::vector<int>& swap_groups = groups_map_.at(swap);
-  for (int elt_group : elt_groups) {
-    if (current_grpcards_[elt_group] + 1 > ks_[elt_group] &&
-        std::find(swap_groups.begin(), swap_groups.end(), elt_group) ==
-            swap_groups.end()) {
-      return false;
+  assert(!current_set_.Contains(element));
+  assert(current_set_.Contains(swap));
+  // All full groups containing the element must contain the swap; they all
+  // contain the lowest one.
+  const int tight = LowestTightAncestor(NodeOf(element));
+  return tight == -1 || IsAncestor(tight, NodeOf(swap));
+}
+
+std::vector<int> LaminarMatroid::GetAllSwaps(int element) const {
+  const int tight = LowestTightAncestor(NodeOf(element));
+  const int subtree = tight == -1 ? num_groups_ : tight;
+  // The member lists of the subtree are sorted; merge them.
+  std::vector<int> all_swaps;
+  std::vector<int64_t> bounds = {0};
+  for (int i = entry_[subtree]; i < exit_[subtree]; ++i) {
+    const std::vector<int>& members = node_members_[preorder_[i]];
+    if (!members.empty()) {
+      all_swaps.insert(all_swaps.end(), members.begin(), members.end());
+      bounds.push_back(all_swaps.size());
     }
   }
-  return true;
+  MergeSortedRuns(all_swaps, bounds);
+  return all_swaps;
 }
 
 void LaminarMatroid::Add(int element) {
-  assert(!current_set_.count(element));
-  std::vector<int> elt_groups = groups_map_.at(element);
-  for (int elt_group : elt_groups) {
-    current_grpcards_[elt_group]++;
+  assert(!current_set_.Contains(element));
+  const int node = NodeOf(element);
+  std::vector<int>& members = node_members_[node];
+  members.insert(std::lower_bound(members.begin(), members.end(), element),
+                 element);
+  for (int group = node; group != num_groups_; group = parent_[group]) {
+    current_grpcards_[group]++;
+    if (current_grpcards_[group] == ks_[group] + 1) {
+      num_groups_over_bound_++;
+    }
   }
-  current_set_.insert(element);
+  current_set_.Insert(element);
 }
 
 void LaminarMatroid::Remove(int element) {
-  assert(current_set_.count(element));
-  std::vector<int> elt_groups = groups_map_.at(element);
-  for (int elt_group : elt_groups) {
-    current_grpcards_[elt_group]--;
+  assert(current_set_.Contains(element));
+  const int node = NodeOf(element);
+  std::vector<int>& members = node_members_[node];
+  members.erase(std::lower_bound(members.begin(), members.end(), element));
+  for (int group = node; group != num_groups_; group = parent_[group]) {
+    if (current_grpcards_[group] == ks_[group] + 1) {
+      num_groups_over_bound_--;
+    }
+    current_grpcards_[group]--;
   }
-  current_set_.erase(element);
+  current_set_.Erase(element);
 }
 
 bool LaminarMatroid::IsFeasible(const std::vector<int>& elements) const {
   std::vector<int> grpcards = std::vector<int>(num_groups_, 0);
-  std::vector<int> elt_groups;
   for (int elt : elements) {
-    elt_groups = groups_map_.at(elt);
-    for (int elt_group : elt_groups) {
-      grpcards[elt_group]++;
-      if (grpcards[elt_group] > ks_[elt_group]) {
+    for (int group = NodeOf(elt); group != num_groups_;
+         group = parent_[group]) {
+      grpcards[group]++;
+      if (grpcards[group] > ks_[group]) {
         return false;
       }
     }
@@ -83,20 +180,15 @@ bool LaminarMatroid::IsFeasible(const std::vector<int>& elements) const {
 }
 
 bool LaminarMatroid::CurrentIsFeasible() const {
-  for (int i = 0; i < num_groups_; ++i) {
-    if (current_grpcards_[i] > ks_[i]) {
-      return false;
-    }
-  }
-  return true;
+  return num_groups_over_bound_ == 0;
 }
 
-std::vector<int> LaminarMatroid::GetCurrent() const {
-  return std::vector<int>(current_set_.begin(), current_set_.end());
+const std::vector<int>& LaminarMatroid::CurrentMembers() const {
+  return current_set_.members();
 }
 
 bool LaminarMatroid::InCurrent(int element) const {
-  return current_set_.count(element);
+  return current_set_.Contains(element);
 }
 
 std::unique_ptr<Matroid> LaminarMatroid::Clone() const {
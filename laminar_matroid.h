@@ -4,15 +4,26 @@
 #ifndef FAIR_SUBMODULAR_MATROID_LAMINAR_MATROID_H_
 #define FAIR_SUBMODULAR_MATROID_LAMINAR_MATROID_H_
 
+#include <cassert>
 #include <map>
 #include <memory>
-#include <set>
 #include <vector>
 
 #include "matroid.h"
+#include "sparse_set.h"
+
+// The groups are arranged in a tree: the parent of a group is the smallest
+// group strictly containing it, and a virtual root without a bound is the
+// parent of the maximal groups. Each element is attached to the smallest
+// group containing it (or the root), so the groups of an element are the
+// ancestors of its node, and each node counts the current elements in its
+// subtree. Updates and CanAdd take O(depth) time; CanSwap takes O(depth)
+// time and GetAllSwaps only looks at the subtree of the lowest full group.
 
 class LaminarMatroid : public Matroid {
  public:
+  // groups_map maps each universe element to the groups containing it. Fails
+  // if the groups are not laminar.
   LaminarMatroid(const std::map<int, std::vector<int>>& groups_map,
                  const std::vector<int>& ks);
 
@@ -27,6 +38,10 @@ class LaminarMatroid : public Matroid {
   // Return whether add element while removing anothe one would be feasible.
   bool CanSwap(int element, int swap) const override;
 
+  // Returns all possible swaps for a given new element, i.e., the current
+  // elements in the lowest full group containing it.
+  std::vector<int> GetAllSwaps(int element) const override;
+
   // Add an element. Assumes that the element can be added.
   void Add(int element) override;
 
@@ -36,11 +51,11 @@ class LaminarMatroid : public Matroid {
   // Checks if a set is feasible.
   bool IsFeasible(const std::vector<int>& elements) const override;
 
-  // Checks whether the current set is feasible.
+  // Checks whether the current set is feasible. Takes O(1) time.
   bool CurrentIsFeasible() const override;
 
-  // Return the current set.
-  std::vector<int> GetCurrent() const override;
+  // Returns the current set, in no particular order.
+  const std::vector<int>& CurrentMembers() const override;
 
   // Returns whether an element is in the current set.
   bool InCurrent(int element) const override;
@@ -49,16 +64,43 @@ class LaminarMatroid : public Matroid {
   std::unique_ptr<Matroid> Clone() const override;
 
  private:
-  // map universe elements to list of groups they belong to
-  std::map<int, std::vector<int>> groups_map_;
-  // groups upper bounds
+  // Returns the tree node of an element, which must belong to the universe.
+  int NodeOf(int element) const {
+    assert(element >= 0 && element < nodes_.size() && nodes_[element] >= 0);
+    return nodes_[element];
+  }
+
+  // Returns the lowest full group (one whose bound is reached) among the
+  // node and its ancestors, or -1 if there is none.
+  int LowestTightAncestor(int node) const;
+
+  // Returns whether `ancestor` is the node or one of its ancestors.
+  bool IsAncestor(int ancestor, int node) const {
+    return entry_[ancestor] <= entry_[node] && entry_[node] < exit_[ancestor];
+  }
+
+  // nodes_[e] is the smallest group containing universe element e (or the
+  // root), or -1 if e is not in the universe
+  std::vector<int> nodes_;
+  // groups upper bounds; the root, node num_groups_, has no bound
   std::vector<int> ks_;
   // number of groups
   int num_groups_;
-  // current number of elements per group
+  // parent of each group; -1 for the root
+  std::vector<int> parent_;
+  // preorder interval [entry_[v], exit_[v]) of the subtree of each node
+  std::vector<int> entry_;
+  std::vector<int> exit_;
+  // nodes in preorder
+  std::vector<int> preorder_;
+  // current number of elements per group (in its subtree)
   std::vector<int> current_grpcards_;
+  // current elements attached to each node, in increasing order
+  std::vector<std::vector<int>> node_members_;
+  // number of groups whose current number of elements exceeds their bound
+  int num_groups_over_bound_ = 0;
   // current set
-  std::set<int> current_set_;
+  SparseSet current_set_;
 };
 
 #endif  // FAIR_SUBMODULAR_MATROID_LAMINAR_MATROID_H_
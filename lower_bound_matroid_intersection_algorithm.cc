@@ -8,6 +8,7 @@
 #include <iterator>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "fairness_constraint.h"
@@ -15,8 +16,9 @@
 #include "matroid_intersection.h"
 #include "submodular_function.h"
 
-LowerBoundMatroidIntersectionAlgorithm::LowerBoundMatroidIntersectionAlgorithm(PostprocessingType postprocessing)
-    : postprocessing_(postprocessing) {}
+LowerBoundMatroidIntersectionAlgorithm::LowerBoundMatroidIntersectionAlgorithm(
+    PostprocessingType postprocessing, const GreedyOptions& greedy_options)
+    : postprocessing_(postprocessing), greedy_options_(greedy_options) {}
 
 void LowerBoundMatroidIntersectionAlgorithm::Init(const SubmodularFunction& sub_func_f,
                                  const FairnessConstraint& fairness,
@@ -33,7 +35,13 @@ void LowerBoundMatroidIntersectionAlgorithm::Insert(int element) {
 double LowerBoundMatroidIntersectionAlgorithm::GetSolutionValue() {
   std::unique_ptr<Matroid> lower_matroid = fairness_->LowerBoundsToMatroid();
   std::vector<int> all_elements = universe_elements_;
-  MaxIntersection(matroid_.get(), lower_matroid.get(), all_elements);
+  if (cache_ != nullptr) {
+    cache_->LowerBoundMaxIntersection(matroid_.get(), lower_matroid.get(),
+                                      all_elements, warm_start_);
+  } else {
+    MaxIntersection(matroid_.get(), lower_matroid.get(), all_elements,
+                    warm_start_);
+  }
   std::vector<int> solution = matroid_->GetCurrent();
   assert(fairness_->IsFeasible(solution));
 
@@ -51,11 +59,21 @@ double LowerBoundMatroidIntersectionAlgorithm::GetSolutionValue() {
     std::set_difference(all_elements.begin(), all_elements.end(),
                         solution.begin(), solution.end(),
                         std::inserter(elements_left, elements_left.begin()));
-    std::sort(elements_left.begin(), elements_left.end(),
-              [this](int lhs, int rhs) {
-                return sub_func_f_->DeltaAndIncreaseOracleCall(lhs) >
-                       sub_func_f_->DeltaAndIncreaseOracleCall(rhs);
+    // The deltas are all taken w.r.t. the same state, so compute them once.
+    std::vector<double> deltas;
+    sub_func_f_->DeltaBatchAndIncreaseOracleCall(elements_left, &deltas);
+    std::vector<std::pair<int, double>> elements_and_deltas;
+    for (int i = 0; i < elements_left.size(); ++i) {
+      elements_and_deltas.emplace_back(elements_left[i], deltas[i]);
+    }
+    std::sort(elements_and_deltas.begin(), elements_and_deltas.end(),
+              [](const std::pair<int, double>& lhs,
+                 const std::pair<int, double>& rhs) {
+                return lhs.second > rhs.second;
               });
+    for (int i = 0; i < elements_left.size(); ++i) {
+      elements_left[i] = elements_and_deltas[i].first;
+    }
     for (int element : elements_left) {
       if (fairness_->CanAdd(element) && matroid_->CanAdd(element)) {
         fairness_->Add(element);
@@ -72,7 +90,7 @@ double LowerBoundMatroidIntersectionAlgorithm::GetSolutionValue() {
     }
     // now all of: matroid_, upper_matroid, and sub_func_f_ have the solution.
     Greedy(matroid_.get(), upper_matroid.get(), sub_func_f_.get(),
-           universe_elements_);
+           universe_elements_, greedy_options_);
     solution = matroid_->GetCurrent();
     assert(fairness_->IsFeasible(solution));
   } // else if postprocessing_ == NONE, do nothing.
@@ -81,7 +99,10 @@ double LowerBoundMatroidIntersectionAlgorithm::GetSolutionValue() {
   return sub_func_f_->ObjectiveAndIncreaseOracleCall(solution_);
 }
 
-std::vector<int> LowerBoundMatroidIntersectionAlgorithm::GetSolutionVector() { return solution_; }
+const std::vector<int>&
+LowerBoundMatroidIntersectionAlgorithm::GetSolutionVector() {
+  return solution_;
+}
 
 std::string LowerBoundMatroidIntersectionAlgorithm::GetAlgorithmName() const {
   switch (postprocessing_) {
@@ -89,8 +110,12 @@ std::string LowerBoundMatroidIntersectionAlgorithm::GetAlgorithmName() const {
       return "Lower bound matroid intersection algorithm (postprocessing=NONE)";
     case FAST_GREEDY:
       return "Lower bound matroid intersection algorithm (postprocessing=FAST_GREEDY)";
-    case GREEDY:
-      return "Lower bound matroid intersection algorithm (postprocessing=GREEDY)";
+    case GREEDY: {
+      const std::string greedy = GreedyOptionsToString(greedy_options_);
+      return std::string("Lower bound matroid intersection algorithm "
+                         "(postprocessing=GREEDY") +
+             (greedy.empty() ? "" : ": " + greedy) + ")";
+    }
     default:
       assert(false && "Unknown postprocessing type.");
       return "Lower bound matroid intersection algorithm (postprocessing=UNKNOWN)";
@@ -11,6 +11,7 @@
 #include "fairness_constraint.h"
 #include "algorithm.h"
 #include "matroid.h"
+#include "matroid_intersection.h"
 #include "submodular_function.h"
 
 class LowerBoundMatroidIntersectionAlgorithm : public Algorithm {
@@ -21,7 +22,10 @@ class LowerBoundMatroidIntersectionAlgorithm : public Algorithm {
     GREEDY = 2 // O-tilde(nk) time greedy algorithm
   };
 
-  explicit LowerBoundMatroidIntersectionAlgorithm(PostprocessingType postprocessing);
+  // greedy_options selects the greedy variant for GREEDY postprocessing.
+  explicit LowerBoundMatroidIntersectionAlgorithm(
+      PostprocessingType postprocessing,
+      const GreedyOptions& greedy_options = GreedyOptions());
 
   // Initialize the algorithm state.
   void Init(const SubmodularFunction& sub_func_f,
@@ -35,7 +39,7 @@ class LowerBoundMatroidIntersectionAlgorithm : public Algorithm {
   double GetSolutionValue() override;
 
   // Gets current solution. Only call this after calling GetSolutionValue().
-  std::vector<int> GetSolutionVector() override;
+  const std::vector<int>& GetSolutionVector() override;
 
   // Gets the name of the algorithm.
   std::string GetAlgorithmName() const override;
@@ -43,6 +47,9 @@ class LowerBoundMatroidIntersectionAlgorithm : public Algorithm {
  private:
   PostprocessingType postprocessing_;
 
+  // Which variant of Greedy() to use.
+  GreedyOptions greedy_options_;
+
   std::vector<int> universe_elements_;
 
   // The final solution set.
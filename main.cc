@@ -3,6 +3,8 @@
 
 // Experiments for fair submodular maximization.
 
+#include <stdint.h>
+
 #include <algorithm>
 #include <fstream>
 #include <functional>
@@ -30,6 +32,7 @@
 #include "movies_mixed_utility_function.h"
 #include "partition_matroid.h"
 #include "submodular_function.h"
+#include "subroutine_cache.h"
 #include "two_pass_algorithm_with_conditioned_matroid.h"
 #include "utilities.h"
 #include "random_algorithm.h"
@@ -54,12 +57,25 @@ void PrintSolutionVector(const std::vector<int>& solution, std::ofstream& fout,
   fout << std::endl;
 }
 
+// Computes a maximum common independent set of the matroid and the lower
+// bounds, augmenting from `*solution` (e.g. the one of the previous rank)
+// and storing the new one there. Goes through `cache` unless it is nullptr.
 bool FeasibleSolutionExists(std::unique_ptr<Matroid>& matroid,
                             FairnessConstraint& fairness,
-                            const std::vector<int>& universe) {
-  MaxIntersection(matroid.get(), fairness.LowerBoundsToMatroid().get(),
-                  universe);
-  std::vector<int> solution = matroid->GetCurrent();
+                            const std::vector<int>& universe,
+                            SubroutineCache* cache,
+                            std::vector<int>* solution_ptr) {
+  std::unique_ptr<Matroid> lower_bound_matroid =
+      fairness.LowerBoundsToMatroid();
+  if (cache != nullptr) {
+    cache->LowerBoundMaxIntersection(matroid.get(), lower_bound_matroid.get(),
+                                     universe, *solution_ptr);
+  } else {
+    MaxIntersection(matroid.get(), lower_bound_matroid.get(), universe,
+                    *solution_ptr);
+  }
+  *solution_ptr = matroid->GetCurrent();
+  const std::vector<int>& solution = *solution_ptr;
   std::cout << "Is feasible: " << matroid->IsFeasible(solution) << " "
             << fairness.IsFeasible(solution) << std::endl;
   return fairness.IsFeasible(solution);
@@ -67,124 +83,167 @@ bool FeasibleSolutionExists(std::unique_ptr<Matroid>& matroid,
 
 bool IsRandomized(Algorithm& alg) {
   return alg.GetAlgorithmName() == "Random algorithm" || 
-         alg.GetAlgorithmName().find("Approximate Fairness") == 0;
+         alg.GetAlgorithmName().find("Approximate Fairness") == 0 ||
+         alg.GetAlgorithmName().find("stochastic greedy") !=
+             std::string::npos;
 }
 
 // global parameters, set in main() from command line arguments
 bool save_solutions = false;
 int random_repeats = 10;
+// Memory budget for the clustering distance cache (0 disables it).
+int64_t distance_cache_mb = 1024;
+// Which variant of Greedy() the algorithms use.
+GreedyOptions greedy_options;
+// Whether the upper bound algorithm continues greedy across ranks.
+bool greedy_continuation = false;
+// Whether one ApproximateFairnessAlgorithm sweeps over all epsilons.
+bool epsilon_sweep = false;
+// Whether the algorithms share subroutine results within a rank.
+bool use_subroutine_cache = true;
+// Whether the coverage graph's binary file is mapped with huge pages.
+bool graph_huge_pages = false;
+
+// Writes the result row of one algorithm (variant) for one rank, with the
+// average and sample standard deviation over repeated runs.
+void WriteResultRow(std::ofstream& of, std::ofstream& general_log_file,
+                    const int rank, const std::vector<double>& values,
+                    const std::vector<int>& errors,
+                    const std::vector<double>& lb_ratios) {
+  of << rank << " ";
+  // Computing average and variance.
+  if (values.size() != 1) {
+    double average_value = 0., average_error = 0., average_ratio = 0.;
+    double var_value = 0., var_error = 0., var_ratio = 0.;
+    for (auto& value : values) average_value += value;
+    for (auto& error : errors) average_error += error;
+    for (auto& ratio : lb_ratios) average_ratio += ratio;
+    average_value /= values.size();
+    average_error /= errors.size();
+    average_ratio /= lb_ratios.size();
+    for (auto& value : values)
+      var_value += (value - average_value) * (value - average_value);
+    double samplestddev_value = sqrt(var_value / (values.size() - 1));
+    for (auto& error : errors)
+      var_error += (error - average_error) * (error - average_error);
+    double samplestddev_error = sqrt(var_error / (errors.size() - 1));
+    for (auto& ratio : lb_ratios)
+      var_ratio += (ratio - average_ratio) * (ratio - average_ratio);
+    std::cout << "Average value: " << average_value << " "
+              << samplestddev_value << std::endl;
+    of << average_value << " ";
+    general_log_file << "Variance in % for rank = " << rank << " "
+                     << sqrt(var_value / (values.size() - 1)) / average_value
+                     << std::endl;
+    std::cout << "Average error: " << average_error << " "
+              << samplestddev_error << std::endl;
+    of << average_error << " ";
+    std::cout << "Average ratio: " << average_ratio << " "
+              << sqrt(var_ratio / (lb_ratios.size() - 1)) << std::endl;
+    //of << average_ratio << " ";
+
+    of << samplestddev_value << " ";
+    of << samplestddev_error << " ";
+  } else {
+    of << values[0] << " ";
+    of << errors[0] << " ";
+    //of << lb_ratios[0] << " ";
+  }
+}
 
 // GetSolutionValue() should always be called once, before GetSolutionVector()
+// result_files and solutions_files have one entry per variant of each
+// algorithm, in order.
 void SingleKBaseExperiment(
     SubmodularFunction& f, const int rank,
     const std::unique_ptr<Matroid>& matroid, const FairnessConstraint& fairness,
     const std::vector<std::reference_wrapper<Algorithm>>& algorithms,
+    const std::vector<int>& feasible_solution, SubroutineCache* cache,
     std::vector<std::ofstream>& result_files,
     std::vector<std::ofstream>& solutions_files,
     std::ofstream& general_log_file) {
   int number_of_colors = fairness.GetColorNum();
   // Fixing the parameters.
   // Running all the algorithms. For the random algorithms, we repeat random_repeats times.
+  int first_variant = 0;
   for (int idx = 0; idx < algorithms.size(); idx++) {
     // Reset seed for fair comparison
     RandomHandler::generator_.seed(1);
 
     Algorithm& alg = algorithms[idx];
-    std::ofstream& of = result_files[idx];
+    const int num_variants = alg.GetNumberOfVariants();
 
-    of << rank << " ";
     int num_rep = 1;
     // For the random algorithms, we repeat random_repeats times.
     if (IsRandomized(alg)) {
       num_rep = random_repeats;
     }
 
-    std::vector<double> values;
-    std::vector<int> errors;
-    std::vector<double> lb_ratios;
-    
+    // Per variant.
+    std::vector<std::vector<double>> values(num_variants);
+    std::vector<std::vector<int>> errors(num_variants);
+    std::vector<std::vector<double>> lb_ratios(num_variants);
+    std::vector<int64_t> oracle_calls(num_variants, 0);
+
     for (int j = 0; j < num_rep; j++) {
       std::cout << "Now running " << alg.GetAlgorithmName()
                 << " with rank=" << rank << "...\n";
       alg.Init(f, fairness, *matroid);
+      alg.SetWarmStart(feasible_solution);
+      alg.SetSubroutineCache(use_subroutine_cache ? cache : nullptr);
       const std::vector<int>& universe = f.GetUniverse();
       for (int i = 0; i < universe.size(); i++) {
         alg.Insert(universe[i]);
       }
-      double solution_value = alg.GetSolutionValue();
-      std::cout << "Value: " << solution_value << std::endl;
-      values.push_back(solution_value);
-      std::vector<int> solution = alg.GetSolutionVector();
-      if (num_rep == 1) {
-        PrintSolutionVector(solution, general_log_file, alg.GetAlgorithmName(),
-                            rank);
-      }
-      if (save_solutions) {
-        PrintSolutionVector(solution, solutions_files[idx],
-                          alg.GetAlgorithmName(), rank, false);
-      }
+      for (int v = 0; v < num_variants; v++) {
+        const std::string name = alg.GetVariantName(v);
+        double solution_value = alg.GetVariantSolutionValue(v);
+        std::cout << "Value: " << solution_value << std::endl;
+        values[v].push_back(solution_value);
+        const std::vector<int>& solution = alg.GetVariantSolutionVector(v);
+        if (num_rep == 1) {
+          PrintSolutionVector(solution, general_log_file, name, rank);
+        }
+        if (save_solutions) {
+          PrintSolutionVector(solution, solutions_files[first_variant + v],
+                              name, rank, false);
+        }
 
-      std::vector<int> occurance(number_of_colors, 0);
-      std::vector<std::pair<int, int>> bounds = fairness.GetBounds();
-      for (int i = 0; i < solution.size(); i++) {
-        occurance[fairness.GetColor(solution[i])]++;
-      }
-      int error = 0;
-      double ratio = 1;
-      std::cout << "Color distribution: ";
-      for (int i = 0; i < occurance.size(); i++) {
-        std::cout << occurance[i] << " ";
-        error += std::max(0, occurance[i] - bounds[i].second);
-        error += std::max(0, -occurance[i] + bounds[i].first);
-        ratio = std::min(
-            ratio, static_cast<double>(occurance[i]) / (bounds[i].first / 2));
+        std::vector<int> occurance(number_of_colors, 0);
+        std::vector<std::pair<int, int>> bounds = fairness.GetBounds();
+        for (int i = 0; i < solution.size(); i++) {
+          occurance[fairness.GetColor(solution[i])]++;
+        }
+        int error = 0;
+        double ratio = 1;
+        std::cout << "Color distribution: ";
+        for (int i = 0; i < occurance.size(); i++) {
+          std::cout << occurance[i] << " ";
+          error += std::max(0, occurance[i] - bounds[i].second);
+          error += std::max(0, -occurance[i] + bounds[i].first);
+          ratio = std::min(
+              ratio, static_cast<double>(occurance[i]) / (bounds[i].first / 2));
+        }
+        std::cout << std::endl << "error :" << error << std::endl << std::endl;
+        std::cout << "worst lower bound ratio :" << ratio << std::endl
+                  << std::endl;
+        errors[v].push_back(error);
+        lb_ratios[v].push_back(ratio);
+        if (num_variants > 1) {
+          oracle_calls[v] += alg.GetVariantOracleCalls(v);
+        }
       }
-      std::cout << std::endl << "error :" << error << std::endl << std::endl;
-      std::cout << "worst lower bound ratio :" << ratio << std::endl
-                << std::endl;
-      errors.push_back(error);
-      lb_ratios.push_back(ratio);
     }
-    // Computing average and variance.
-    if (num_rep != 1) {
-      double average_value = 0., average_error = 0., average_ratio = 0.;
-      double var_value = 0., var_error = 0., var_ratio = 0.;
-      for (auto& value : values) average_value += value;
-      for (auto& error : errors) average_error += error;
-      for (auto& ratio : lb_ratios) average_ratio += ratio;
-      average_value /= values.size();
-      average_error /= errors.size();
-      average_ratio /= lb_ratios.size();
-      for (auto& value : values)
-        var_value += (value - average_value) * (value - average_value);
-      double samplestddev_value = sqrt(var_value / (values.size() - 1));
-      for (auto& error : errors)
-        var_error += (error - average_error) * (error - average_error);
-      double samplestddev_error = sqrt(var_error / (errors.size() - 1));
-      for (auto& ratio : lb_ratios)
-        var_ratio += (ratio - average_ratio) * (ratio - average_ratio);
-      std::cout << "Average value: " << average_value << " "
-                << samplestddev_value << std::endl;
-      of << average_value << " ";
-      general_log_file << "Variance in % for rank = " << rank << " "
-                       << sqrt(var_value / (values.size() - 1)) / average_value
-                       << std::endl;
-      std::cout << "Average error: " << average_error << " "
-                << samplestddev_error << std::endl;
-      of << average_error << " ";
-      std::cout << "Average ratio: " << average_ratio << " "
-                << sqrt(var_ratio / (lb_ratios.size() - 1)) << std::endl;
-      //of << average_ratio << " ";
-
-      of << samplestddev_value << " ";
-      of << samplestddev_error << " ";
-    } else {
-      of << values[0] << " ";
-      of << errors[0] << " ";
-      //of << lb_ratios[0] << " ";
+    // Each variant gets the oracle calls of a separate run for it.
+    for (int v = 0; v < num_variants; v++) {
+      std::ofstream& of = result_files[first_variant + v];
+      WriteResultRow(of, general_log_file, rank, values[v], errors[v],
+                     lb_ratios[v]);
+      of << (num_variants > 1 ? oracle_calls[v] : f.oracle_calls_)
+         << std::endl;
     }
-    of << f.oracle_calls_ << std::endl;
     f.oracle_calls_ = 0;
+    first_variant += num_variants;
   }
 }
 
@@ -194,35 +253,42 @@ void BaseExperiment(SubmodularFunction& f, std::vector<int>& ranks,
                     std::string exp_name) {
   // Algorithms to run
   //TwoPassAlgorithmWithConditionedMatroid two_pass_swap(false);
-  TwoPassAlgorithmWithConditionedMatroid two_pass_greedy(true);
+  TwoPassAlgorithmWithConditionedMatroid two_pass_greedy(true, greedy_options);
   //LowerBoundMatroidIntersectionAlgorithm lbalgo_fastgreedy(
   //    LowerBoundMatroidIntersectionAlgorithm::FAST_GREEDY);
   LowerBoundMatroidIntersectionAlgorithm lbalgo_greedy(
-      LowerBoundMatroidIntersectionAlgorithm::GREEDY);
-  UpperBoundMatroidIntersectionAlgorithm ubalgo_greedy(true);
+      LowerBoundMatroidIntersectionAlgorithm::GREEDY, greedy_options);
+  UpperBoundMatroidIntersectionAlgorithm ubalgo_greedy(true, greedy_options,
+                                                       greedy_continuation);
   //UpperBoundMatroidIntersectionAlgorithm ubalgo_swap(false); 
   //ApproximateFairnessAlgorithm approx_fair_10(1.0);
   //ApproximateFairnessAlgorithm approx_fair_09(0.9);
-  ApproximateFairnessAlgorithm approx_fair_08(0.8);
+  ApproximateFairnessAlgorithm approx_fair_08(0.8, greedy_options);
   //ApproximateFairnessAlgorithm approx_fair_07(0.7);
   //ApproximateFairnessAlgorithm approx_fair_06(0.6);
-  ApproximateFairnessAlgorithm approx_fair_05(0.5);
+  ApproximateFairnessAlgorithm approx_fair_05(0.5, greedy_options);
   //ApproximateFairnessAlgorithm approx_fair_04(0.4);
   //ApproximateFairnessAlgorithm approx_fair_03(0.3);
-  ApproximateFairnessAlgorithm approx_fair_02(0.2);
+  ApproximateFairnessAlgorithm approx_fair_02(0.2, greedy_options);
   //ApproximateFairnessAlgorithm approx_fair_01(0.1);
   //ApproximateFairnessAlgorithm approx_fair_00(0.0);
+  ApproximateFairnessAlgorithm approx_fair_sweep({0.8, 0.5, 0.2},
+                                                 greedy_options);
   RandomAlgorithm random;
 
   std::vector<std::reference_wrapper<Algorithm>> algorithms = {
     random,
     lbalgo_greedy,
     ubalgo_greedy,
-    two_pass_greedy,
-    approx_fair_08,
-    approx_fair_05,
-    approx_fair_02
+    two_pass_greedy
   };
+  if (epsilon_sweep) {
+    algorithms.push_back(approx_fair_sweep);
+  } else {
+    algorithms.push_back(approx_fair_08);
+    algorithms.push_back(approx_fair_05);
+    algorithms.push_back(approx_fair_02);
+  }
 
   // Create files to output results and save solution sets.
   std::vector<std::ofstream> result_files;
@@ -230,29 +296,38 @@ void BaseExperiment(SubmodularFunction& f, std::vector<int>& ranks,
   std::string exp_base_path = "results/" + exp_name;
 
   for (Algorithm& alg : algorithms) {
-    result_files.emplace_back(exp_base_path + "_" + alg.GetAlgorithmName() +
-                              ".txt");
-    const std::string csv_header_row = IsRandomized(alg)
-        ? "rank f error stddev_f stddev_error OC"
-        : "rank f error OC";
-    result_files.back() << csv_header_row << std::endl;
-    if (save_solutions) {
-      solutions_files.emplace_back(exp_base_path + "_sols_" +
-                                   alg.GetAlgorithmName() + ".txt");
+    for (int v = 0; v < alg.GetNumberOfVariants(); v++) {
+      const std::string name = alg.GetVariantName(v);
+      result_files.emplace_back(exp_base_path + "_" + name + ".txt");
+      const std::string csv_header_row = IsRandomized(alg)
+          ? "rank f error stddev_f stddev_error OC"
+          : "rank f error OC";
+      result_files.back() << csv_header_row << std::endl;
+      if (save_solutions) {
+        solutions_files.emplace_back(exp_base_path + "_sols_" + name + ".txt");
+      }
     }
   }
   std::ofstream general_log_file(exp_base_path + "_general.txt");
 
+  // A maximum common independent set of the matroid and the lower bounds for
+  // the last rank. As bounds grow with the rank, it is a good starting point
+  // for the next one.
+  std::vector<int> feasible_solution;
   for (int i = 0; i < ranks.size(); i++) {
+    // Subroutine results for this rank, shared by all algorithms.
+    SubroutineCache cache;
     // Skip rank if no feasible solution
-    if (!FeasibleSolutionExists(matroids[i], fairness[i], f.GetUniverse())) {
+    if (!FeasibleSolutionExists(matroids[i], fairness[i], f.GetUniverse(),
+                                use_subroutine_cache ? &cache : nullptr,
+                                &feasible_solution)) {
       std::cerr << "No feasible solution for " << exp_name
                 << " with rank = " << ranks[i] << std::endl;
       continue;
     }
 
     SingleKBaseExperiment(f, ranks[i], matroids[i], fairness[i], algorithms,
-                          result_files, solutions_files, general_log_file);
+                          feasible_solution, &cache, result_files, solutions_files, general_log_file);
   }
   for (std::ofstream& of : result_files) of.close();
 
@@ -263,7 +338,7 @@ void BaseExperiment(SubmodularFunction& f, std::vector<int>& ranks,
 
 void ClusteringExperiment() {
   BankData data;
-  ClusteringFunction f(data.input_);
+  ClusteringFunction f(data.input_, distance_cache_mb << 20);
   int ngrps = (int)data.balance_grpcards_.size();
   int ncolors = (int)data.age_grpcards_.size();
 
@@ -290,7 +365,7 @@ void ClusteringExperiment() {
 }
 
 void CoverageExperiment(int lower_i, int upper_i) {
-  Graph graph("pokec_age_BMI");  // "pokec_BMI_age"
+  Graph graph("pokec_age_BMI", graph_huge_pages);  // "pokec_BMI_age"
   GraphUtility f(graph);
   int n = graph.GetUniverseVertices().size();
   std::cout << "n = " << n << std::endl;
@@ -482,8 +557,41 @@ int main(int argc, char* argv[]) {
       save_solutions = true;
     } else if (arg == "--random-repeats" && i + 1 < argc) {
       random_repeats = std::stoi(argv[++i]);
+    } else if (arg == "--distance-cache-mb" && i + 1 < argc) {
+      distance_cache_mb = std::stoll(argv[++i]);
+    } else if (arg == "--greedy" && i + 1 < argc) {
+      const std::string variant = argv[++i];
+      if (variant == "exact") {
+        greedy_options.evaluation = EXACT_GREEDY;
+      } else if (variant == "lazy") {
+        greedy_options.evaluation = LAZY_GREEDY;
+      } else if (variant == "stochastic") {
+        greedy_options.evaluation = STOCHASTIC_GREEDY;
+      } else if (variant == "threshold") {
+        greedy_options.evaluation = THRESHOLD_GREEDY;
+      } else {
+        Fail("unknown greedy variant " + variant);
+      }
+    } else if (arg == "--greedy-epsilon" && i + 1 < argc) {
+      greedy_options.epsilon = std::stod(argv[++i]);
+    } else if (arg == "--greedy-threads" && i + 1 < argc) {
+      greedy_options.num_threads = std::stoi(argv[++i]);
+    } else if (arg == "--greedy-continuation") {
+      greedy_continuation = true;
+    } else if (arg == "--epsilon-sweep") {
+      epsilon_sweep = true;
+    } else if (arg == "--no-subroutine-cache") {
+      use_subroutine_cache = false;
+    } else if (arg == "--graph-huge-pages") {
+      graph_huge_pages = true;
+    } else if (arg == "--threads" && i + 1 < argc) {
+      SetNumThreads(std::stoi(argv[++i]));
     }
   }
+  if (greedy_continuation && greedy_options.evaluation != EXACT_GREEDY &&
+      greedy_options.evaluation != LAZY_GREEDY) {
+    Fail("--greedy-continuation only supports --greedy exact or lazy");
+  }
 
   if (run_clustering) {
     ClusteringExperiment();
@@ -495,7 +603,7 @@ int main(int argc, char* argv[]) {
     CoverageExperiment(1, 10);
   }
   if (!run_movies && !run_coverage && !run_clustering) {
-    std::cout << "Usage: " << argv[0] << " [--movies] [--coverage] [--clustering] [--save-solutions] [--random-repeats N]" << std::endl;
+    std::cout << "Usage: " << argv[0] << " [--movies] [--coverage] [--clustering] [--save-solutions] [--random-repeats N] [--distance-cache-mb N] [--greedy exact|lazy|stochastic|threshold] [--greedy-epsilon X] [--greedy-threads N] [--threads N] [--greedy-continuation] [--epsilon-sweep] [--no-subroutine-cache] [--graph-huge-pages]" << std::endl;
   }
   return 0;
 }
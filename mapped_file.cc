@@ -0,0 +1,83 @@
+// Copyright 2025 The Authors (see AUTHORS file)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "mapped_file.h"
+
+#include <stddef.h>
+
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define FAIR_SUBMODULAR_MATROID_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string& path,
+                                             bool use_huge_pages) {
+  std::unique_ptr<MappedFile> file(new MappedFile());
+#ifdef FAIR_SUBMODULAR_MATROID_HAVE_MMAP
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return nullptr;
+  }
+  if (st.st_size > 0) {
+    void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      close(fd);
+      return nullptr;
+    }
+#ifdef MADV_HUGEPAGE
+    if (use_huge_pages) {
+      madvise(mapping, st.st_size, MADV_HUGEPAGE);
+    }
+#endif
+    file->mapping_ = mapping;
+    file->mapping_size_ = st.st_size;
+  }
+  close(fd);
+#else
+  std::ifstream input(path, std::ios::binary);
+  if (!input) {
+    return nullptr;
+  }
+  file->buffer_.assign(std::istreambuf_iterator<char>(input),
+                       std::istreambuf_iterator<char>());
+#endif
+  return file;
+}
+
+std::unique_ptr<MappedFile> MappedFile::FromBuffer(std::vector<char> buffer) {
+  std::unique_ptr<MappedFile> file(new MappedFile());
+  file->buffer_ = std::move(buffer);
+  return file;
+}
+
+MappedFile::~MappedFile() {
+#ifdef FAIR_SUBMODULAR_MATROID_HAVE_MMAP
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+  }
+#endif
+}
+
+const char* MappedFile::data() const {
+  return mapping_ != nullptr ? static_cast<const char*>(mapping_)
+                             : buffer_.data();
+}
+
+size_t MappedFile::size() const {
+  return mapping_ != nullptr ? mapping_size_ : buffer_.size();
+}
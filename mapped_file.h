@@ -0,0 +1,51 @@
+// Copyright 2025 The Authors (see AUTHORS file)
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef FAIR_SUBMODULAR_MATROID_MAPPED_FILE_H_
+#define FAIR_SUBMODULAR_MATROID_MAPPED_FILE_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Read-only bytes of a whole file. Memory-mapped on POSIX systems, read into
+// memory elsewhere. Can also wrap a buffer that is already in memory, so that
+// callers can treat both the same way.
+
+class MappedFile {
+ public:
+  // Maps the file at `path`. Returns nullptr if it cannot be opened.
+  // If use_huge_pages is set, asks the kernel to back the mapping with huge
+  // pages (only a hint; ignored where unsupported).
+  static std::unique_ptr<MappedFile> Open(const std::string& path,
+                                          bool use_huge_pages);
+
+  // Takes ownership of bytes already in memory.
+  static std::unique_ptr<MappedFile> FromBuffer(std::vector<char> buffer);
+
+  ~MappedFile();
+
+  // Forbids copying.
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // Returns the first byte.
+  const char* data() const;
+
+  // Returns the number of bytes.
+  size_t size() const;
+
+ private:
+  MappedFile() = default;
+
+  // Start and length of the mapping, if the file is mapped.
+  void* mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+
+  // The contents, if the file is not mapped.
+  std::vector<char> buffer_;
+};
+
+#endif  // FAIR_SUBMODULAR_MATROID_MAPPED_FILE_H_
@@ -3,16 +3,20 @@
 
 #include "matroid.h"
 
+#include <algorithm>
 #include <cassert>
 #include <vector>
 
 std::vector<int> Matroid::GetAllSwaps(int element) const {
   std::vector<int> all_swaps;
-  for (int swap : GetCurrent()) {
+  for (int swap : CurrentMembers()) {
     if (CanSwap(element, swap)) {
       all_swaps.push_back(swap);
     }
   }
+  // Only the swaps found are sorted; subclasses that keep a sorted view of
+  // the current set override this.
+  std::sort(all_swaps.begin(), all_swaps.end());
   return all_swaps;
 }
 
@@ -25,10 +29,14 @@ void Matroid::Swap(int element, int swap) {
 bool Matroid::CurrentIsFeasible() const { return IsFeasible(GetCurrent()); }
 
 bool Matroid::InCurrent(int element) const {
-  for (int current_element : GetCurrent()) {
-    if (current_element == element) {
-      return true;
-    }
-  }
-  return false;
+  const std::vector<int>& current = CurrentMembers();
+  return std::find(current.begin(), current.end(), element) != current.end();
+}
+
+int Matroid::CurrentSize() const { return CurrentMembers().size(); }
+
+std::vector<int> Matroid::GetCurrent() const {
+  std::vector<int> current = CurrentMembers();
+  std::sort(current.begin(), current.end());
+  return current;
 }
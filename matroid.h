@@ -20,7 +20,7 @@ class Matroid {
   // Return whether add element while removing anothe one would be feasible.
   virtual bool CanSwap(int element, int swap) const = 0;
 
-  // Returns all possible swaps for a given new element.
+  // Returns all possible swaps for a given new element, in increasing order.
   virtual std::vector<int> GetAllSwaps(int elements) const;
 
   // Add an element. Assumes that the element can be added.
@@ -38,8 +38,16 @@ class Matroid {
   // Checks whether the current set is feasible.
   virtual bool CurrentIsFeasible() const;
 
-  // Return the current set.
-  virtual std::vector<int> GetCurrent() const = 0;
+  // Returns the current set as a contiguous array, in no particular order.
+  // The reference is invalidated by Add, Swap, Remove and Reset.
+  virtual const std::vector<int>& CurrentMembers() const = 0;
+
+  // Returns the number of elements in the current set.
+  int CurrentSize() const;
+
+  // Returns a copy of the current set, in increasing order. Meant for callers
+  // outside the matroid code; prefer CurrentMembers() and CurrentSize().
+  std::vector<int> GetCurrent() const;
 
   // Returns whether an element is in the current set.
   virtual bool InCurrent(int element) const = 0;
@@ -4,26 +4,180 @@
 #include "matroid_intersection.h"
 
 #include <cassert>
+#include <cmath>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <memory>
 #include <queue>
+#include <random>
 #include <set>
+#include <string>
 #include <vector>
 #include <unordered_map>
+#include <utility>
 #include <algorithm>
 
 #include "utilities.h"
+#include "flow_network.h"
 #include "matroid.h"
 #include "partition_matroid.h"
 #include "fairness_constraint.h"
 #include "submodular_function.h"
+#include "subroutine_cache.h"
 
-void MaxIntersection(Matroid* matroid_a, Matroid* matroid_b,
-                     const std::vector<int>& elements) {
-  matroid_a->Reset();
-  matroid_b->Reset();
-  // Adjacency lists;
-  std::map<int, std::vector<int>> exchange_graph;
+namespace {
+
+// Number of elements per task when expanding a BFS layer in parallel.
+constexpr int kExpansionChunkSize = 256;
+
+// Returns the number of tasks for expanding `size` elements.
+int NumChunks(int size) {
+  return (size + kExpansionChunkSize - 1) / kExpansionChunkSize;
+}
+
+// MaxIntersection() for two partition matroids, augmenting from their current
+// common set (which must be a subset of `elements`). Both matroids only bound
+// how many elements are taken from each (group in a, group in b) cell, so
+// this is a b-matching between the groups of a and the groups of b, solved as
+// a maximum flow on a network with one node per group and one edge per
+// non-empty cell. Apart from collecting the cells, the running time does not
+// depend on the number of elements.
+void PartitionMaxIntersection(PartitionMatroid* matroid_a,
+                              PartitionMatroid* matroid_b,
+                              const std::vector<int>& elements) {
+  // Greedily add elements to the solution, as the generic version does.
+  for (int element : elements) {
+    if (matroid_a->InCurrent(element)) {
+      continue;
+    }
+    if (matroid_a->CanAdd(element) && matroid_b->CanAdd(element)) {
+      matroid_a->Add(element);
+      matroid_b->Add(element);
+    }
+  }
+
+  // The elements of each non-empty cell, in the order of `elements`, and how
+  // many of them are in the current set.
+  struct Cell {
+    int group_a;
+    int group_b;
+    std::vector<int> elements;
+    int taken = 0;
+    int edge = -1;
+  };
+  std::vector<Cell> cells;
+  std::map<std::pair<int, int>, int> cell_ids;
+  for (int element : elements) {
+    const std::pair<int, int> groups(matroid_a->GetGroup(element),
+                                     matroid_b->GetGroup(element));
+    auto it = cell_ids.find(groups);
+    if (it == cell_ids.end()) {
+      it = cell_ids.emplace(groups, cells.size()).first;
+      cells.push_back({groups.first, groups.second, {}});
+    }
+    Cell& cell = cells[it->second];
+    cell.elements.push_back(element);
+    if (matroid_a->InCurrent(element)) {
+      ++cell.taken;
+    }
+  }
+
+  // Nodes: source, the groups of a, the groups of b, sink. The network starts
+  // with the flow of the current set.
+  const int num_groups_a = matroid_a->GetGroupsNum();
+  const int num_groups_b = matroid_b->GetGroupsNum();
+  const int source = 0;
+  const int sink = num_groups_a + num_groups_b + 1;
+  std::vector<int64_t> taken_a(num_groups_a, 0), taken_b(num_groups_b, 0);
+  for (const Cell& cell : cells) {
+    taken_a[cell.group_a] += cell.taken;
+    taken_b[cell.group_b] += cell.taken;
+  }
+  FlowNetwork network(sink + 1);
+  for (int group = 0; group < num_groups_a; ++group) {
+    network.AddEdge(source, 1 + group, matroid_a->GetGroupBound(group),
+                    taken_a[group]);
+  }
+  for (int group = 0; group < num_groups_b; ++group) {
+    network.AddEdge(1 + num_groups_a + group, sink,
+                    matroid_b->GetGroupBound(group), taken_b[group]);
+  }
+  for (Cell& cell : cells) {
+    cell.edge = network.AddEdge(1 + cell.group_a,
+                                1 + num_groups_a + cell.group_b,
+                                cell.elements.size(), cell.taken);
+  }
+  if (network.Augment(source, sink) == 0) {
+    return;
+  }
+
+  // Move the current set to the new flow: first drop the last taken elements
+  // of cells whose flow decreased, then take the first free elements of cells
+  // whose flow increased, so the set stays feasible throughout.
+  for (const Cell& cell : cells) {
+    int excess = cell.taken - network.GetFlow(cell.edge);
+    for (auto it = cell.elements.rbegin(); excess > 0; ++it) {
+      if (matroid_a->InCurrent(*it)) {
+        matroid_a->Remove(*it);
+        matroid_b->Remove(*it);
+        --excess;
+      }
+    }
+  }
+  for (const Cell& cell : cells) {
+    int missing = network.GetFlow(cell.edge) - cell.taken;
+    for (auto it = cell.elements.begin(); missing > 0; ++it) {
+      if (!matroid_a->InCurrent(*it)) {
+        matroid_a->Add(*it);
+        matroid_b->Add(*it);
+        --missing;
+      }
+    }
+  }
+}
+
+// MaxIntersection() for arbitrary matroids, augmenting from their current
+// common set (which must be a subset of `elements`), with Cunningham's
+// shortest augmenting paths. Each phase computes the BFS layers of the
+// exchange graph once, and then augments along as many vertex-disjoint paths
+// through these layers as a depth-first search finds, checking each edge
+// against the current sets when it is used. Augmenting along a shortest path
+// never decreases distances, so every such path is a shortest augmenting path
+// when it is applied. Elements are addressed by their position in `elements`.
+void GenericMaxIntersection(Matroid* matroid_a, Matroid* matroid_b,
+                            const std::vector<int>& elements) {
+  const int n = elements.size();
+  std::unordered_map<int, int> position;
+  position.reserve(n);
+  for (int i = 0; i < n; ++i) {
+    position.emplace(elements[i], i);
+  }
+  // kind[i] = whether elements[i] is in the current set (kInCurrent), can be
+  // added in a (kSource), or neither (kOther).
+  enum : char { kInCurrent, kSource, kOther };
+  std::vector<char> kind(n);
+  // distance[i] = BFS layer of elements[i] in the current phase, or -1.
+  std::vector<int> distance(n);
+  // Elements of each layer, and for each element the next candidate in the
+  // following layer to try (as in Dinic's algorithm).
+  std::vector<std::vector<int>> layers;
+  std::vector<int> next_candidate(n);
+  // Edges x -> y leaving even layers, in CSR form: the targets of x are
+  // edge_targets[edge_begin[x], edge_begin[x] + edge_count[x]).
+  std::vector<int> edge_targets;
+  std::vector<int64_t> edge_begin(n);
+  std::vector<int> edge_count(n);
+  // Per-chunk buffers for building the edges in parallel.
+  std::vector<std::vector<int>> chunk_targets;
+  std::vector<char> is_sink;
+  // Whether an element was used by a path or is a dead end in this phase.
+  std::vector<char> removed(n);
+  std::vector<int> unlabeled;
+  std::vector<int> first_reached;
+  std::vector<int> bucket_begin;
+  std::vector<int> path;
   while (true) {
     // Greedily add elements to the solution;
     for (int element : elements) {
@@ -36,67 +190,237 @@ void MaxIntersection(Matroid* matroid_a, Matroid* matroid_b,
       }
     }
 
-    // Construct the exchange graph.
-    exchange_graph.clear();
-    for (int element : elements) {
-      if (matroid_a->InCurrent(element)) {
-        continue;
+    // Compute the layers: even layers hold elements outside the current set
+    // (layer 0: those that can be added in a), odd layers elements in it. An
+    // edge x -> y means x can replace y in b, and y -> x that x can replace y
+    // in a. Stop at the first layer with an element that can be added in b.
+    // Each layer is expanded in parallel (the matroids are only queried
+    // through const methods), and merged in the order a sequential BFS would
+    // discover the elements.
+    ParallelFor(NumChunks(n), [&](int chunk) {
+      for (int i = chunk * kExpansionChunkSize;
+           i < std::min(n, (chunk + 1) * kExpansionChunkSize); ++i) {
+        if (matroid_a->InCurrent(elements[i])) {
+          kind[i] = kInCurrent;
+        } else {
+          kind[i] = matroid_a->CanAdd(elements[i]) ? kSource : kOther;
+        }
       }
-      for (int a_swap : matroid_a->GetAllSwaps(element)) {
-        exchange_graph[a_swap].push_back(element);
+    });
+    layers.clear();
+    unlabeled.clear();
+    edge_targets.clear();
+    layers.emplace_back();
+    for (int i = 0; i < n; ++i) {
+      distance[i] = -1;
+      if (kind[i] == kSource) {
+        distance[i] = 0;
+        layers[0].push_back(i);
+      } else if (kind[i] == kOther) {
+        unlabeled.push_back(i);
       }
-      for (int b_swap : matroid_b->GetAllSwaps(element)) {
-        exchange_graph[element].push_back(b_swap);
+    }
+    int last_layer = -1;
+    for (int layer = 0; last_layer == -1 && !layers[layer].empty(); ++layer) {
+      const std::vector<int>& current_layer = layers[layer];
+      const int size = current_layer.size();
+      const int num_chunks = NumChunks(size);
+      std::vector<int> next_layer;
+      if (layer % 2 == 0) {
+        is_sink.assign(size, false);
+        chunk_targets.resize(num_chunks);
+        ParallelFor(num_chunks, [&](int chunk) {
+          std::vector<int>& targets = chunk_targets[chunk];
+          targets.clear();
+          for (int i = chunk * kExpansionChunkSize;
+               i < std::min(size, (chunk + 1) * kExpansionChunkSize); ++i) {
+            const int x = current_layer[i];
+            if (matroid_b->CanAdd(elements[x])) {
+              is_sink[i] = true;
+              continue;
+            }
+            const std::vector<int> swaps = matroid_b->GetAllSwaps(elements[x]);
+            edge_count[x] = 0;
+            for (int swap : swaps) {
+              auto it = position.find(swap);
+              if (it != position.end()) {
+                targets.push_back(it->second);
+                ++edge_count[x];
+              }
+            }
+          }
+        });
+        if (std::find(is_sink.begin(), is_sink.end(), true) != is_sink.end()) {
+          last_layer = layer;
+          break;
+        }
+        for (int chunk = 0; chunk < num_chunks; ++chunk) {
+          int64_t offset = edge_targets.size();
+          for (int i = chunk * kExpansionChunkSize;
+               i < std::min(size, (chunk + 1) * kExpansionChunkSize); ++i) {
+            edge_begin[current_layer[i]] = offset;
+            offset += edge_count[current_layer[i]];
+          }
+          edge_targets.insert(edge_targets.end(), chunk_targets[chunk].begin(),
+                              chunk_targets[chunk].end());
+        }
+        for (int x : current_layer) {
+          for (int64_t e = edge_begin[x]; e < edge_begin[x] + edge_count[x];
+               ++e) {
+            const int y = edge_targets[e];
+            if (distance[y] == -1) {
+              distance[y] = layer + 1;
+              next_layer.push_back(y);
+            }
+          }
+        }
+      } else {
+        // An unlabeled x joins the next layer with the first y that reaches
+        // it; order by that y, then by position in `unlabeled`.
+        const int num_unlabeled = unlabeled.size();
+        first_reached.assign(num_unlabeled, -1);
+        ParallelFor(NumChunks(num_unlabeled), [&](int chunk) {
+          for (int i = chunk * kExpansionChunkSize;
+               i < std::min(num_unlabeled, (chunk + 1) * kExpansionChunkSize);
+               ++i) {
+            for (int j = 0; j < size; ++j) {
+              if (matroid_a->CanSwap(elements[unlabeled[i]],
+                                     elements[current_layer[j]])) {
+                first_reached[i] = j;
+                break;
+              }
+            }
+          }
+        });
+        bucket_begin.assign(size + 1, 0);
+        for (int j : first_reached) {
+          if (j != -1) {
+            ++bucket_begin[j + 1];
+          }
+        }
+        for (int j = 0; j < size; ++j) {
+          bucket_begin[j + 1] += bucket_begin[j];
+        }
+        next_layer.resize(bucket_begin[size]);
+        int kept = 0;
+        for (int i = 0; i < num_unlabeled; ++i) {
+          const int x = unlabeled[i];
+          if (first_reached[i] == -1) {
+            unlabeled[kept++] = x;
+          } else {
+            distance[x] = layer + 1;
+            next_layer[bucket_begin[first_reached[i]]++] = x;
+          }
+        }
+        unlabeled.resize(kept);
       }
+      layers.push_back(std::move(next_layer));
+    }
+    if (last_layer == -1) {
+      // No augmenting path found.
+      break;
     }
 
-    // Find an augmenting path via BFS.
-    std::map<int, int> bfs_parent;
-    std::queue<int> queue;
-    int aug_path_dest = -1;
-    for (int element : elements) {
-      if (matroid_a->InCurrent(element)) {
+    // Augment along vertex-disjoint paths from layer 0 to last_layer.
+    std::fill(removed.begin(), removed.end(), false);
+    std::fill(next_candidate.begin(), next_candidate.end(), 0);
+    for (int source : layers[0]) {
+      if (removed[source] || !matroid_a->CanAdd(elements[source])) {
         continue;
       }
-      if (matroid_a->CanAdd(element)) {
-        bfs_parent[element] = -1;
-        queue.push(element);
+      path.assign(1, source);
+      while (!path.empty()) {
+        const int u = path.back();
+        const int layer = distance[u];
+        if (layer == last_layer) {
+          if (matroid_b->CanAdd(elements[u])) {
+            break;
+          }
+          removed[u] = true;
+          path.pop_back();
+          continue;
+        }
+        // Candidates: the edges found by the BFS for even layers, the whole
+        // next layer for odd ones. Edges are re-checked, since earlier
+        // augmentations of this phase may have removed them.
+        const bool even = layer % 2 == 0;
+        const int* candidates = even ? edge_targets.data() + edge_begin[u]
+                                     : layers[layer + 1].data();
+        const int num_candidates =
+            even ? edge_count[u] : layers[layer + 1].size();
+        int& next = next_candidate[u];
+        for (; next < num_candidates; ++next) {
+          const int v = candidates[next];
+          if (removed[v] || distance[v] != layer + 1) {
+            continue;
+          }
+          const bool edge =
+              even ? matroid_b->CanSwap(elements[u], elements[v])
+                   : matroid_a->CanSwap(elements[v], elements[u]);
+          if (edge) {
+            break;
+          }
+        }
+        if (next == num_candidates) {
+          removed[u] = true;
+          path.pop_back();
+        } else {
+          path.push_back(candidates[next++]);
+        }
       }
-    }
-    while (!queue.empty()) {
-      const int element = queue.front();
-      queue.pop();
-      if (!matroid_b->InCurrent(element) && matroid_b->CanAdd(element)) {
-        aug_path_dest = element;
-        break;
+      if (path.empty()) {
+        continue;
       }
-      for (int neighbor : exchange_graph[element]) {
-        if (!bfs_parent.count(neighbor)) {
-          bfs_parent[neighbor] = element;
-          queue.push(neighbor);
-        }
+      // Swap along the augmenting path x0 y1 x1 ... yk xk.
+      for (int i = path.size() - 1; i > 0; i -= 2) {
+        matroid_a->Swap(elements[path[i]], elements[path[i - 1]]);
+        matroid_b->Swap(elements[path[i]], elements[path[i - 1]]);
+      }
+      matroid_a->Add(elements[path[0]]);
+      matroid_b->Add(elements[path[0]]);
+      for (int v : path) {
+        removed[v] = true;
       }
     }
+  }
+}
 
-    if (aug_path_dest == -1) {
-      // No augmenting path found.
-      break;
-    }
+// Augments the current common set of the two matroids to a maximum one.
+void AugmentToMaxIntersection(Matroid* matroid_a, Matroid* matroid_b,
+                              const std::vector<int>& elements) {
+  PartitionMatroid* partition_a = dynamic_cast<PartitionMatroid*>(matroid_a);
+  PartitionMatroid* partition_b = dynamic_cast<PartitionMatroid*>(matroid_b);
+  if (partition_a != nullptr && partition_b != nullptr) {
+    PartitionMaxIntersection(partition_a, partition_b, elements);
+  } else {
+    GenericMaxIntersection(matroid_a, matroid_b, elements);
+  }
+}
+
+}  // namespace
 
-    // Swap along the augmenting path.
-    std::cerr << "we are applying an augmenting path" << std::endl;
-    int out_element = aug_path_dest;
-    int in_element = bfs_parent[aug_path_dest];
-    while (in_element != -1) {
-      matroid_a->Swap(out_element, in_element);
-      matroid_b->Swap(out_element, in_element);
-      out_element = bfs_parent[in_element];
-      in_element = bfs_parent[out_element];
+void MaxIntersection(Matroid* matroid_a, Matroid* matroid_b,
+                     const std::vector<int>& elements) {
+  matroid_a->Reset();
+  matroid_b->Reset();
+  AugmentToMaxIntersection(matroid_a, matroid_b, elements);
+  assert(matroid_a->CurrentIsFeasible());
+  assert(matroid_b->CurrentIsFeasible());
+}
+
+void MaxIntersection(Matroid* matroid_a, Matroid* matroid_b,
+                     const std::vector<int>& elements,
+                     const std::vector<int>& start) {
+  matroid_a->Reset();
+  matroid_b->Reset();
+  for (int element : start) {
+    if (!matroid_a->InCurrent(element) && matroid_a->CanAdd(element) &&
+        matroid_b->CanAdd(element)) {
+      matroid_a->Add(element);
+      matroid_b->Add(element);
     }
-    matroid_a->Add(out_element);
-    matroid_b->Add(out_element);
   }
-
+  AugmentToMaxIntersection(matroid_a, matroid_b, elements);
   assert(matroid_a->CurrentIsFeasible());
   assert(matroid_b->CurrentIsFeasible());
 }
@@ -116,8 +440,8 @@ std::vector<int> FairMaxIntersection(Matroid* matroid_a, FairnessConstraint* fai
   for (int i = 0; i < bounds.size(); i++) {
     lower_bound_sum += bounds[i].first;
   }
-  // Check if the size of lower_bound_matroid->GetCurrent() is equal to the sum of lower bound contraints in fairness_constraints
-  if (lower_bound_matroid->GetCurrent().size() != lower_bound_sum) {
+  // Check if the size of lower_bound_matroid's current set is equal to the sum of lower bound contraints in fairness_constraints
+  if (lower_bound_matroid->CurrentSize() != lower_bound_sum) {
     std::cerr << "No fair set exists" << std::endl;
     return std::vector<int>();
   }
@@ -125,84 +449,13 @@ std::vector<int> FairMaxIntersection(Matroid* matroid_a, FairnessConstraint* fai
   std::unique_ptr<Matroid> matroid_b_ptr = fairness_constraints->UpperBoundsToMatroid();
   Matroid* matroid_b = matroid_b_ptr.get();
 
-  for (int element : lower_bound_matroid->GetCurrent()) {
+  for (int element : lower_bound_matroid->CurrentMembers()) {
     matroid_b->Add(element);
   }
-  // Now we have a fair set in matroid_a and matroid_b. We finish off by taking any valid augmenting paths. 
-  // Adjacency lists;
-  std::map<int, std::vector<int>> exchange_graph;
-  while (true) {
-    // Greedily add elements to the solution;
-    for (int element : elements) {
-      if (matroid_a->InCurrent(element)) {
-        continue;
-      }
-      if (matroid_a->CanAdd(element) && matroid_b->CanAdd(element)) {
-        matroid_a->Add(element);
-        matroid_b->Add(element);
-      }
-    }
-
-    // Construct the exchange graph.
-    exchange_graph.clear();
-    for (int element : elements) {
-      if (matroid_a->InCurrent(element)) {
-        continue;
-      }
-      for (int a_swap : matroid_a->GetAllSwaps(element)) {
-        exchange_graph[a_swap].push_back(element);
-      }
-      for (int b_swap : matroid_b->GetAllSwaps(element)) {
-        exchange_graph[element].push_back(b_swap);
-      }
-    }
-
-    // Find an augmenting path via BFS.
-    std::map<int, int> bfs_parent;
-    std::queue<int> queue;
-    int aug_path_dest = -1;
-    for (int element : elements) {
-      if (matroid_a->InCurrent(element)) {
-        continue;
-      }
-      if (matroid_a->CanAdd(element)) {
-        bfs_parent[element] = -1;
-        queue.push(element);
-      }
-    }
-    while (!queue.empty()) {
-      const int element = queue.front();
-      queue.pop();
-      if (!matroid_b->InCurrent(element) && matroid_b->CanAdd(element)) {
-        aug_path_dest = element;
-        break;
-      }
-      for (int neighbor : exchange_graph[element]) {
-        if (!bfs_parent.count(neighbor)) {
-          bfs_parent[neighbor] = element;
-          queue.push(neighbor);
-        }
-      }
-    }
-
-    if (aug_path_dest == -1) {
-      // No augmenting path found.
-      break;
-    }
-
-    // Swap along the augmenting path.
-    std::cerr << "we are applying an augmenting path" << std::endl;
-    int out_element = aug_path_dest;
-    int in_element = bfs_parent[aug_path_dest];
-    while (in_element != -1) {
-      matroid_a->Swap(out_element, in_element);
-      matroid_b->Swap(out_element, in_element);
-      out_element = bfs_parent[in_element];
-      in_element = bfs_parent[out_element];
-    }
-    matroid_a->Add(out_element);
-    matroid_b->Add(out_element);
-  }
+  // Now we have a fair set in matroid_a and matroid_b. We finish off by taking
+  // any valid augmenting paths. Augmenting never removes an element from a
+  // color (for partition matroids see FlowNetwork), so the set stays fair.
+  AugmentToMaxIntersection(matroid_a, matroid_b, elements);
 
   assert(matroid_a->CurrentIsFeasible());
   assert(matroid_b->CurrentIsFeasible());
@@ -261,12 +514,56 @@ void SubMaxIntersectionSwapping(Matroid* matroid_a, Matroid* matroid_b,
   }
 }
 
-// This method runs the greedy algorithm
-std::vector<int> Greedy(Matroid* matroid_a, Matroid* matroid_b, SubmodularFunction* sub_func_f, const std::vector<int>& universe){
+namespace {
+
+// Computes marginal gains for the Greedy() variants, optionally in parallel on
+// replicas of the function, which it keeps in the same state.
+class GainEvaluator {
+ public:
+  // Uses num_threads - 1 clones of sub_func_f besides sub_func_f itself.
+  GainEvaluator(SubmodularFunction* sub_func_f, int num_threads)
+      : sub_func_f_(sub_func_f) {
+    for (int i = 1; i < num_threads; ++i) {
+      clones_.push_back(sub_func_f->Clone());
+      replicas_.push_back(clones_.back().get());
+    }
+  }
+
+  // Computes the gain of every element in `elements` into `gains`.
+  void DeltaBatch(const std::vector<int>& elements,
+                  std::vector<double>* gains) {
+    sub_func_f_->ParallelDeltaBatchAndIncreaseOracleCall(elements, replicas_,
+                                                          gains);
+  }
+
+  // Returns the gain of one element.
+  double Delta(int element) {
+    return sub_func_f_->DeltaAndIncreaseOracleCall(element);
+  }
+
+  // Adds an element to the function and all its replicas.
+  void Add(int element) {
+    sub_func_f_->Add(element);
+    for (SubmodularFunction* replica : replicas_) {
+      replica->Add(element);
+    }
+  }
+
+ private:
+  SubmodularFunction* sub_func_f_;
+  std::vector<std::unique_ptr<SubmodularFunction>> clones_;
+  std::vector<SubmodularFunction*> replicas_;
+};
+
+// Greedy() with EXACT_GREEDY evaluation.
+void ExactGreedy(Matroid* matroid_a, Matroid* matroid_b,
+                 GainEvaluator* evaluator,
+                 const std::vector<int>& universe) {
+  std::vector<int> candidates;
+  std::vector<double> gains;
   while (true) {
-    // Find the element with the maximum marginal gain.
-    double max_gain = 0;
-    int best_element = -1;
+    // Collect the elements that can be added to both matroids.
+    candidates.clear();
     for (int element : universe) {
       if (matroid_a->InCurrent(element) || matroid_b->InCurrent(element)) {
         // Skip if the element is already in the matroid.
@@ -276,249 +573,577 @@ std::vector<int> Greedy(Matroid* matroid_a, Matroid* matroid_b, SubmodularFuncti
         // Skip if the element cannot be added to both matroids.
         continue;
       }
-      double gain = sub_func_f->DeltaAndIncreaseOracleCall(element);
-      if (gain > max_gain) {
-        max_gain = gain;
-        best_element = element;
+      candidates.push_back(element);
+    }
+    // Find the element with the maximum marginal gain.
+    evaluator->DeltaBatch(candidates, &gains);
+    double max_gain = 0;
+    int best_element = -1;
+    for (int i = 0; i < candidates.size(); ++i) {
+      if (gains[i] > max_gain) {
+        max_gain = gains[i];
+        best_element = candidates[i];
       }
     }
+    if (best_element == -1) {
+      return;
+    }
     // Add the best element to the matroid.
-    if (best_element != -1) {
-      matroid_a->Add(best_element);
-      matroid_b->Add(best_element);
-      sub_func_f->Add(best_element);
-    } else {
-      if (!matroid_a->CurrentIsFeasible() || !matroid_b->CurrentIsFeasible()) {
-        std::cerr << "Something is wrong with this method! The current solution is not feasible" << std::endl;
-        return std::vector<int>(); 
+    matroid_a->Add(best_element);
+    matroid_b->Add(best_element);
+    evaluator->Add(best_element);
+  }
+}
+
+// The main loop of LazyGreedy(): pops the top of `bounds` (entries are
+// (gain bound, -position in universe)) and adds it if its bound was computed
+// in the current step, or re-evaluates it otherwise. The current step is the
+// number of elements in `added`, to which the added elements are appended.
+// Elements that cannot be added are passed to on_blocked (if set) with their
+// bound.
+void LazyGreedySteps(
+    Matroid* matroid_a, Matroid* matroid_b, GainEvaluator* evaluator,
+    const std::vector<int>& universe,
+    std::priority_queue<std::pair<double, int>>* bounds,
+    std::vector<int>* evaluated_in_step, std::vector<int>* added,
+    const std::function<void(int pos, double bound)>& on_blocked) {
+  while (!bounds->empty()) {
+    const int pos = -bounds->top().second;
+    const double bound = bounds->top().first;
+    const int element = universe[pos];
+    bounds->pop();
+    if (!matroid_a->CanAdd(element) || !matroid_b->CanAdd(element)) {
+      if (on_blocked) {
+        on_blocked(pos, bound);
       }
-      return matroid_a->GetCurrent(); 
+      continue;
+    }
+    const int step = added->size();
+    if ((*evaluated_in_step)[pos] == step) {
+      // No other element can have a larger gain.
+      matroid_a->Add(element);
+      matroid_b->Add(element);
+      evaluator->Add(element);
+      added->push_back(element);
+      continue;
+    }
+    const double gain = evaluator->Delta(element);
+    (*evaluated_in_step)[pos] = step;
+    if (gain > 0) {
+      bounds->emplace(gain, -pos);
     }
   }
-  return matroid_a->GetCurrent();
 }
 
-std::vector<std::vector<int>> ReturnPaths(PartitionMatroid* matroid_a, FairnessConstraint* fairness_constraints, SubmodularFunction* sub_func_f, const std::vector<int>& set_Y, const std::vector<int>& set_P) {
-  // First, we're going to create a bipartite directed exchange graph between fairness constraints and matroid_a.
-  // The directed edges are going to be the elements in set_Y and set_P.
-  // Edges i -e-> j mean that e is in set_P. 
-  // Edges i <-e- j mean that e is in set_Y.
-  // We'll use DFS to find augmenting paths, alternating paths (or cycles and remove them) in this graph. 
-  // Start from an unsaturated node in the fairness constraint. End in either an unsaturated node in the fairness constraint or a sink node in the matroid_a.
-  // Remove theis path and add it to the list of paths we'll return. 
+// Greedy() with LAZY_GREEDY evaluation. By submodularity, a marginal gain
+// computed in an earlier step is an upper bound on the current one, so the
+// elements are kept in a max-heap keyed by their last computed gain and only
+// the top one is re-evaluated until it is up to date. By matroid
+// monotonicity, an element that cannot be added now never can again, and by
+// submodularity neither can an element with non-positive gain be chosen, so
+// both are dropped for good.
+void LazyGreedy(Matroid* matroid_a, Matroid* matroid_b,
+                GainEvaluator* evaluator,
+                const std::vector<int>& universe) {
+  // The first step evaluates every feasible element, as ExactGreedy does.
+  std::vector<int> candidates;
+  std::vector<int> positions;
+  for (int pos = 0; pos < universe.size(); ++pos) {
+    const int element = universe[pos];
+    if (matroid_a->InCurrent(element) || matroid_b->InCurrent(element)) {
+      continue;
+    }
+    if (!matroid_a->CanAdd(element) || !matroid_b->CanAdd(element)) {
+      continue;
+    }
+    candidates.push_back(element);
+    positions.push_back(pos);
+  }
+  std::vector<double> gains;
+  evaluator->DeltaBatch(candidates, &gains);
 
-  fairness_constraints->Reset(); // I don't need anything in these constraints right now. 
-  matroid_a->Reset(); 
+  // Among equal bounds the element that comes first in `universe` is on top,
+  // which is the element ExactGreedy would pick among equal gains.
+  std::priority_queue<std::pair<double, int>> bounds;
+  for (int i = 0; i < candidates.size(); ++i) {
+    if (gains[i] > 0) {
+      bounds.emplace(gains[i], -positions[i]);
+    }
+  }
+  std::vector<int> evaluated_in_step(universe.size(), 0);
+  std::vector<int> added;
+  LazyGreedySteps(matroid_a, matroid_b, evaluator, universe, &bounds,
+                  &evaluated_in_step, &added, nullptr);
+}
 
-  std::vector<std::vector<int>> list_of_paths;
+// Returns the elements of `universe` that are not in the current set and can
+// be added to both matroids.
+std::vector<int> FeasibleCandidates(const Matroid& matroid_a,
+                                    const Matroid& matroid_b,
+                                    const std::vector<int>& universe) {
+  std::vector<int> candidates;
+  for (int element : universe) {
+    if (matroid_a.InCurrent(element) || matroid_b.InCurrent(element)) {
+      continue;
+    }
+    if (!matroid_a.CanAdd(element) || !matroid_b.CanAdd(element)) {
+      continue;
+    }
+    candidates.push_back(element);
+  }
+  return candidates;
+}
+
+// Returns the number of elements of `candidates` that can be added to the
+// current sets one after another (on copies of the matroids). This is within
+// a factor of two of the number of steps any greedy algorithm takes, and
+// costs no oracle calls.
+int CountAddable(const Matroid& matroid_a, const Matroid& matroid_b,
+                 const std::vector<int>& candidates) {
+  std::unique_ptr<Matroid> copy_a = matroid_a.Clone();
+  std::unique_ptr<Matroid> copy_b = matroid_b.Clone();
+  int count = 0;
+  for (int element : candidates) {
+    if (copy_a->CanAdd(element) && copy_b->CanAdd(element)) {
+      copy_a->Add(element);
+      copy_b->Add(element);
+      ++count;
+    }
+  }
+  return count;
+}
+
+// Greedy() with STOCHASTIC_GREEDY evaluation (Mirzasoleiman et al.): each step
+// adds the best element of a random sample of (n / k) * log(1 / epsilon)
+// feasible elements, where n is the number of candidates and k estimates the
+// number of steps.
+void StochasticGreedy(Matroid* matroid_a, Matroid* matroid_b,
+                      GainEvaluator* evaluator,
+                      const std::vector<int>& universe, double epsilon) {
+  std::vector<int> remaining =
+      FeasibleCandidates(*matroid_a, *matroid_b, universe);
+  const int steps =
+      std::max(1, CountAddable(*matroid_a, *matroid_b, remaining));
+  const int sample_size = std::max(
+      1, static_cast<int>(std::ceil(static_cast<double>(remaining.size()) /
+                                    steps * std::log(1 / epsilon))));
+  std::vector<int> sample;
+  std::vector<double> gains;
+  while (true) {
+    // Elements that cannot be added now never can again.
+    remaining.erase(
+        std::remove_if(remaining.begin(), remaining.end(),
+                       [&](int element) {
+                         return !matroid_a->CanAdd(element) ||
+                                !matroid_b->CanAdd(element);
+                       }),
+        remaining.end());
+    if (remaining.empty()) {
+      return;
+    }
+    // Move a uniform sample to the front of `remaining`.
+    const int size = std::min<int>(sample_size, remaining.size());
+    for (int i = 0; i < size; ++i) {
+      std::uniform_int_distribution<int> distribution(i, remaining.size() - 1);
+      std::swap(remaining[i],
+                remaining[distribution(RandomHandler::generator_)]);
+    }
+    sample.assign(remaining.begin(), remaining.begin() + size);
+    evaluator->DeltaBatch(sample, &gains);
+    double max_gain = 0;
+    int best_element = -1;
+    for (int i = 0; i < size; ++i) {
+      if (gains[i] > max_gain) {
+        max_gain = gains[i];
+        best_element = sample[i];
+      }
+    }
+    // Sampled elements without a positive gain never get one by
+    // submodularity, so they are dropped along with the added element.
+    int kept = 0;
+    for (int i = 0; i < size; ++i) {
+      if (gains[i] > 0 && sample[i] != best_element) {
+        remaining[kept++] = sample[i];
+      }
+    }
+    remaining.erase(remaining.begin() + kept, remaining.begin() + size);
+    if (best_element != -1) {
+      matroid_a->Add(best_element);
+      matroid_b->Add(best_element);
+      evaluator->Add(best_element);
+    }
+  }
+}
+
+// Greedy() with THRESHOLD_GREEDY evaluation (Badanidiyuru and Vondrak): for
+// thresholds w = d, (1 - epsilon) d, ... down to (epsilon / n) d, where d is
+// the largest single gain, adds every feasible element whose gain is at least
+// w. A gain computed earlier is an upper bound on the current one, so an
+// element is only re-evaluated if that bound reaches the threshold.
+void ThresholdGreedy(Matroid* matroid_a, Matroid* matroid_b,
+                     GainEvaluator* evaluator,
+                     const std::vector<int>& universe, double epsilon) {
+  std::vector<int> candidates =
+      FeasibleCandidates(*matroid_a, *matroid_b, universe);
+  std::vector<double> gains;
+  evaluator->DeltaBatch(candidates, &gains);
+  double max_gain = 0;
+  for (double gain : gains) {
+    max_gain = std::max(max_gain, gain);
+  }
+  // Remaining candidates with their gain bounds, and the number of elements
+  // added when each bound was computed (the bound is exact if none since).
+  std::vector<int> remaining;
+  std::vector<double> bounds;
+  std::vector<int> bound_added;
+  for (int i = 0; i < candidates.size(); ++i) {
+    if (gains[i] > 0) {
+      remaining.push_back(candidates[i]);
+      bounds.push_back(gains[i]);
+      bound_added.push_back(0);
+    }
+  }
+  const double min_threshold = epsilon / remaining.size() * max_gain;
+  int added = 0;
+  for (double threshold = max_gain;
+       threshold >= min_threshold && !remaining.empty();
+       threshold *= 1 - epsilon) {
+    int kept = 0;
+    for (int i = 0; i < remaining.size(); ++i) {
+      const int element = remaining[i];
+      if (!matroid_a->CanAdd(element) || !matroid_b->CanAdd(element)) {
+        continue;
+      }
+      if (bounds[i] >= threshold && bound_added[i] != added) {
+        bounds[i] = evaluator->Delta(element);
+        bound_added[i] = added;
+      }
+      if (bounds[i] >= threshold) {
+        matroid_a->Add(element);
+        matroid_b->Add(element);
+        evaluator->Add(element);
+        ++added;
+        continue;
+      }
+      if (bounds[i] > 0) {
+        remaining[kept] = element;
+        bounds[kept] = bounds[i];
+        bound_added[kept] = bound_added[i];
+        ++kept;
+      }
+    }
+    remaining.resize(kept);
+    bounds.resize(kept);
+    bound_added.resize(kept);
+  }
+}
 
-  std::map<int, std::map<int, int>> exchange_graph; // We're going to think of the LHS as fairness constraints (with odd vertices) and the RHS as matroid_a (with even vertices).
-  std::map<int, int> fair_to_number; // The map that takes in a fairness constraint and maps it to it's vertex number in the exchange graph.
-  std::map<int, int> part_to_number; // The map that takes in a part and maps it to it's vertex number in the exchange graph.
+}  // namespace
 
-  for (int i = 0; i < fairness_constraints->GetColorNum(); i++) {
-    fair_to_number[i] = 2*i + 1; // Odd vertices are fairness constraints.
+std::string GreedyOptionsToString(const GreedyOptions& options) {
+  switch (options.evaluation) {
+    case STOCHASTIC_GREEDY:
+      return "stochastic greedy, epsilon=" + std::to_string(options.epsilon);
+    case THRESHOLD_GREEDY:
+      return "threshold greedy, epsilon=" + std::to_string(options.epsilon);
+    default:
+      return "";
   }
+}
 
-  for (int i = 0; i < matroid_a->GetGroupsNum(); i++) {
-    part_to_number[i] = 2*i + 2; // Even positive vertices are matroid_a.
+// This method runs the greedy algorithm
+std::vector<int> Greedy(Matroid* matroid_a, Matroid* matroid_b,
+                        SubmodularFunction* sub_func_f,
+                        const std::vector<int>& universe,
+                        const GreedyOptions& options) {
+  if (options.evaluation == STOCHASTIC_GREEDY ||
+      options.evaluation == THRESHOLD_GREEDY) {
+    if (!(options.epsilon > 0 && options.epsilon < 1)) {
+      Fail("the epsilon of approximate greedy must be in (0, 1)");
+    }
   }
+  GainEvaluator evaluator(sub_func_f, options.num_threads > 0
+                                          ? options.num_threads
+                                          : HardwareThreads());
+  switch (options.evaluation) {
+    case EXACT_GREEDY:
+      ExactGreedy(matroid_a, matroid_b, &evaluator, universe);
+      break;
+    case LAZY_GREEDY:
+      LazyGreedy(matroid_a, matroid_b, &evaluator, universe);
+      break;
+    case STOCHASTIC_GREEDY:
+      StochasticGreedy(matroid_a, matroid_b, &evaluator, universe,
+                       options.epsilon);
+      break;
+    case THRESHOLD_GREEDY:
+      ThresholdGreedy(matroid_a, matroid_b, &evaluator, universe,
+                      options.epsilon);
+      break;
+  }
+  if (!matroid_a->CurrentIsFeasible() || !matroid_b->CurrentIsFeasible()) {
+    std::cerr << "Something is wrong with this method! The current solution is not feasible" << std::endl;
+    return std::vector<int>();
+  }
+  return matroid_a->GetCurrent();
+}
 
-  std::set<int> Y_union_P(set_Y.begin(), set_Y.end());
-  Y_union_P.insert(set_P.begin(), set_P.end());
+GreedyContinuation::GreedyContinuation(const SubmodularFunction& sub_func_f,
+                                       const std::vector<int>& universe,
+                                       const GreedyOptions& options)
+    : sub_func_f_(sub_func_f.Clone()), universe_(universe), options_(options) {}
 
-  // Iterate over the union set
-  for (const int& element : Y_union_P) {
-    // Find out what fairness constraint this element belongs to. 
-    int fairness_constraint = fairness_constraints->GetColor(element);
-    int part = matroid_a->GetGroup(element);
+void GreedyContinuation::Start(Matroid* matroid_a, Matroid* matroid_b) {
+  sub_func_f_->Reset();
+  solution_.clear();
+  bounds_ = std::priority_queue<std::pair<double, int>>();
+  // -1 = never evaluated.
+  evaluated_in_step_.assign(universe_.size(), -1);
+  blocked_.clear();
+  diverged_ = false;
 
-    if (std::find(set_P.begin(), set_P.end(), element) != set_P.end() &&
-        std::find(set_Y.begin(), set_Y.end(), element) != set_Y.end()) {
-      // If the element is in both sets, we don't add any edges.
+  // The first step evaluates every element, as LazyGreedy() does. Elements
+  // that cannot be added even to the empty set are blocked without a bound.
+  std::vector<int> candidates;
+  std::vector<int> positions;
+  for (int pos = 0; pos < universe_.size(); ++pos) {
+    const int element = universe_[pos];
+    if (!matroid_a->CanAdd(element) || !matroid_b->CanAdd(element)) {
+      blocked_.push_back({pos, std::numeric_limits<double>::infinity(), 0});
       continue;
     }
-    
-    if (std::find(set_P.begin(), set_P.end(), element) != set_P.end()) {
-      // Add edges from P to be directed left to right.
-      exchange_graph[fair_to_number[fairness_constraint]][element] = part_to_number[part];
+    candidates.push_back(element);
+    positions.push_back(pos);
+    evaluated_in_step_[pos] = 0;
+  }
+  GainEvaluator evaluator(sub_func_f_.get(), options_.num_threads > 0
+                                                 ? options_.num_threads
+                                                 : HardwareThreads());
+  std::vector<double> gains;
+  evaluator.DeltaBatch(candidates, &gains);
+  for (int i = 0; i < candidates.size(); ++i) {
+    if (gains[i] > 0) {
+      bounds_.emplace(gains[i], -positions[i]);
+    }
+  }
+}
+
+bool GreedyContinuation::Run(Matroid* matroid_a, Matroid* matroid_b) {
+  matroid_a->Reset();
+  matroid_b->Reset();
+  bool relaxed = true;
+  for (int element : solution_) {
+    if (!matroid_a->CanAdd(element) || !matroid_b->CanAdd(element)) {
+      relaxed = false;
+      break;
+    }
+    matroid_a->Add(element);
+    matroid_b->Add(element);
+  }
+  if (!started_ || !relaxed) {
+    matroid_a->Reset();
+    matroid_b->Reset();
+    Start(matroid_a, matroid_b);
+    started_ = true;
+  } else {
+    // The previous steps are those of a cold start unless a blocked element
+    // can now be added to the solution of the step in which it was blocked;
+    // its bound was at least the gain of the element chosen in that step.
+    // Blocked elements that can be added to the whole solution compete again
+    // with their old bound.
+    std::vector<Blocked> still_blocked;
+    std::vector<int> prefix;
+    for (const Blocked& blocked : blocked_) {
+      const int element = universe_[blocked.pos];
+      if (matroid_a->CanAdd(element) && matroid_b->CanAdd(element)) {
+        diverged_ = true;
+        bounds_.emplace(blocked.bound, -blocked.pos);
+        continue;
+      }
+      if (!diverged_) {
+        prefix.assign(solution_.begin(), solution_.begin() + blocked.step);
+        prefix.push_back(element);
+        if (matroid_a->IsFeasible(prefix) && matroid_b->IsFeasible(prefix)) {
+          diverged_ = true;
+        }
+      }
+      still_blocked.push_back(blocked);
     }
-    if (std::find(set_Y.begin(), set_Y.end(), element) != set_Y.end()) {
+    blocked_.swap(still_blocked);
+  }
+
+  GainEvaluator evaluator(sub_func_f_.get(), options_.num_threads > 0
+                                                 ? options_.num_threads
+                                                 : HardwareThreads());
+  LazyGreedySteps(matroid_a, matroid_b, &evaluator, universe_, &bounds_,
+                  &evaluated_in_step_, &solution_,
+                  [this](int pos, double bound) {
+                    blocked_.push_back(
+                        {pos, bound, static_cast<int>(solution_.size())});
+                  });
+  if (!matroid_a->CurrentIsFeasible() || !matroid_b->CurrentIsFeasible()) {
+    Fail("greedy continuation produced an infeasible solution");
+  }
+  return !diverged_;
+}
+
+const std::vector<int>& GreedyContinuation::GetUniverse() const {
+  return universe_;
+}
+
+std::vector<std::vector<int>> ReturnPaths(PartitionMatroid* matroid_a, FairnessConstraint* fairness_constraints, SubmodularFunction* sub_func_f, const std::vector<int>& set_Y, const std::vector<int>& set_P) {
+  // First, we're going to create a bipartite directed exchange graph between fairness constraints and matroid_a.
+  // The directed edges are going to be the elements in set_Y and set_P.
+  // Edges i -e-> j mean that e is in set_P.
+  // Edges i <-e- j mean that e is in set_Y.
+  // We'll walk from every unsaturated node in the fairness constraint, always along the unused out-edge with the
+  // smallest element, until we end in a node without unused out-edges (either an unsaturated node in the fairness
+  // constraint or a sink node in matroid_a) or close a cycle. Paths are added to the list of paths we'll return,
+  // and the edges of paths and cycles are removed. After a cycle, the walk continues from where the cycle started,
+  // which is where a new walk from the same source would get to. As every edge is removed at most once and the
+  // walk never backtracks over a removed edge, this takes linear time after sorting the elements.
+
+  fairness_constraints->Reset(); // I don't need anything in these constraints right now.
+  matroid_a->Reset();
+
+  std::vector<std::vector<int>> list_of_paths;
+
+  // We're going to think of the LHS as fairness constraints (with odd vertices 2 * color + 1) and the RHS as
+  // matroid_a (with even vertices 2 * group + 2).
+  const int num_colors = fairness_constraints->GetColorNum();
+  const int num_groups = matroid_a->GetGroupsNum();
+  const int num_vertices = 2 * std::max(num_colors, num_groups) + 2;
+
+  // The elements of Y and P in increasing order; elements in both sets don't get any edges.
+  std::vector<int> sorted_Y(set_Y);
+  std::vector<int> sorted_P(set_P);
+  std::sort(sorted_Y.begin(), sorted_Y.end());
+  std::sort(sorted_P.begin(), sorted_P.end());
+  // (element, tail, head) of every edge, in increasing order of the element.
+  struct Edge {
+    int element;
+    int tail;
+    int head;
+  };
+  std::vector<Edge> edges;
+  edges.reserve(sorted_Y.size() + sorted_P.size());
+  auto y_it = sorted_Y.begin();
+  auto p_it = sorted_P.begin();
+  while (y_it != sorted_Y.end() || p_it != sorted_P.end()) {
+    const bool take_Y = p_it == sorted_P.end() ||
+                        (y_it != sorted_Y.end() && *y_it <= *p_it);
+    const bool take_P = y_it == sorted_Y.end() ||
+                        (p_it != sorted_P.end() && *p_it <= *y_it);
+    const int element = take_Y ? *y_it : *p_it;
+    const int fair_vertex = 2 * fairness_constraints->GetColor(element) + 1;
+    const int part_vertex = 2 * matroid_a->GetGroup(element) + 2;
+    if (take_Y && !take_P) {
       // Add the edges from Y to be directed right to left.
-      exchange_graph[part_to_number[part]][element] = fair_to_number[fairness_constraint];
+      edges.push_back({element, part_vertex, fair_vertex});
+    } else if (take_P && !take_Y) {
+      // Add edges from P to be directed left to right.
+      edges.push_back({element, fair_vertex, part_vertex});
     }
+    // Skip duplicates of this element.
+    while (y_it != sorted_Y.end() && *y_it == element) ++y_it;
+    while (p_it != sorted_P.end() && *p_it == element) ++p_it;
   }
 
-  //std::cerr << "Built exchange graph" << std::endl;
-  // DEBUGGING: Print out the whole exchange graph.
-  //std::cerr << "Exchange graph: " << std::endl;
-  //for (int a = 0; a < fairness_constraints->GetColors().size(); a++) {
-    //if (exchange_graph[2 * a + 1].size() > 0) {
-    //std::cerr << "Fairness constraint " << 2 * a + 1 << ": ";
-    //for (const auto& pair : exchange_graph[2 * a + 1]) {
-      //std::cerr << pair.first << " , " << pair.second << " | ";
-    //}
-    //std::cerr << std::endl;
-    //}
-  //}
-  //for (int a = 0; a < matroid_a->GetGroups().size(); a++) {
-    //if (exchange_graph[2 * a + 2].size() > 0) {
-    //std::cerr << "Matroid constraint " << 2 * a + 2 << ": ";
-    //for (const auto& pair : exchange_graph[2 * a + 2]) {
-      //std::cerr << pair.first << " , " << pair.second << " | ";
-    //}
-    //std::cerr << std::endl;
-    //}
-  //}
+  // The out-edges of vertex v are targets[first_edge[v]..first_edge[v + 1]) (with elements in edge_element), in
+  // increasing order of the element; the ones before next_edge[v] are removed.
+  std::vector<int> first_edge(num_vertices + 1, 0);
+  for (const Edge& edge : edges) {
+    ++first_edge[edge.tail + 1];
+  }
+  for (int v = 0; v < num_vertices; v++) {
+    first_edge[v + 1] += first_edge[v];
+  }
+  std::vector<int> next_edge(first_edge.begin(), first_edge.end() - 1);
+  std::vector<int> edge_element(edges.size());
+  std::vector<int> targets(edges.size());
+  for (const Edge& edge : edges) {
+    const int slot = next_edge[edge.tail]++;
+    edge_element[slot] = edge.element;
+    targets[slot] = edge.head;
+  }
+  next_edge.assign(first_edge.begin(), first_edge.end() - 1);
 
-  // Now we have to find what the LHS sources are on the fairness constraints. 
+  // Now we have to find what the LHS sources are on the fairness constraints.
   std::vector<int> sources;
-  std::map<int, int> P_out_degree; // a map from LHS vertices (odd number) to out-degree. 
-  std::map<int, int> Y_in_degree;
+  std::vector<int> P_out_degree(num_colors, 0);
+  std::vector<int> Y_in_degree(num_colors, 0);
   for (const int& element : set_P) {
-    int fair = fairness_constraints->GetColor(element);
-    P_out_degree[fair_to_number[fair]]++;
+    P_out_degree[fairness_constraints->GetColor(element)]++;
   }
-
   for (const int& element : set_Y) {
-    int fair = fairness_constraints->GetColor(element);
-    Y_in_degree[fair_to_number[fair]]++;
+    Y_in_degree[fairness_constraints->GetColor(element)]++;
   }
-
-  for (int h = 0; h < fairness_constraints->GetColorNum(); h++) {
-    int lhs_vertex = 2 * h + 1;
-    int difference = P_out_degree[lhs_vertex] - Y_in_degree[lhs_vertex];
-    if (difference > 0) {
-      for (int j = 0; j < difference; j++) {
-        sources.push_back(lhs_vertex);
-      }
+  for (int h = 0; h < num_colors; h++) {
+    int difference = P_out_degree[h] - Y_in_degree[h];
+    for (int j = 0; j < difference; j++) {
+      sources.push_back(2 * h + 1);
     }
   }
 
   std::cerr << "Found sources." << std::endl;
 
-  // DEBUGGING: Print out the sources.
-  //std::cerr << "Sources: " << std::endl;
-  //for (int i = 0; i < sources.size(); i++) {
-    //std::cerr << sources[i] << " ";
-  //}
-  //std::cerr << std::endl;
-  //std::cerr << std::endl;
-
-  // FOR DEBUGGING PURPOSES: Let's look at the sources in random order. 
-  //std::random_device rd;
-  //std::mt19937 g(rd());
-  //std::shuffle(sources.begin(), sources.end(), g);
-  // FOR DEBUGGING PURPOSES: Let's look at the sources in random order.
-
-  for (int i = 0; i < sources.size(); i++) {
-    int source = sources[i];
-    //std::cerr << "Starting from source: " << source << std::endl;
-    int head = source; 
-    
-    std::set<int> visited_vertices;
-    std::vector<std::pair<int, int>> walk;
-
-    bool found_cycle = false;
-    bool reached_sink = false;
-    bool augmenting = false;
-
-    //walk.push_back({-1, head}); // The first element is the edge, the second is the vertex.
-
-    while (!found_cycle && !reached_sink) {
-      visited_vertices.insert(head);
-      int next_edge = exchange_graph[head].begin()->first; 
-      int next_vertex = exchange_graph[head][next_edge];
-      walk.push_back({next_edge, next_vertex});
-
-      head = next_vertex;
-      found_cycle = visited_vertices.count(head) > 0;
-      reached_sink = exchange_graph[head].size() == 0;
-      if (reached_sink) {
-        if (head%2 == 0) { // If the head is even, that means we reached a sink in matroid_a, we have an odd sized path.
-          augmenting = true;
-        }
+  // walk[j] = (element, vertex) of the j-th edge of the current walk; walk_position[v] = the number of edges of
+  // the walk before it reaches v, or -1 if v is not on it.
+  std::vector<std::pair<int, int>> walk;
+  std::vector<int> walk_position(num_vertices, -1);
+  for (int source : sources) {
+    walk.clear();
+    walk_position[source] = 0;
+    int head = source;
+    while (next_edge[head] != first_edge[head + 1]) {
+      const int edge = next_edge[head];
+      walk.push_back({edge_element[edge], targets[edge]});
+      head = targets[edge];
+      if (walk_position[head] == -1) {
+        walk_position[head] = walk.size();
+        continue;
+      }
+      // Remove the cycle from head back to head and continue from there.
+      const int cycle_start = walk_position[head];
+      ++next_edge[head];
+      for (int j = cycle_start; j + 1 < walk.size(); j++) {
+        ++next_edge[walk[j].second];
+        walk_position[walk[j].second] = -1;
       }
+      walk.resize(cycle_start);
     }
-
-    int tail; // The tail is the starting vertex with which we delete edges along the path or cycle. 
-    std::vector<std::pair<int, int>> edges_to_delete;
+    // Reached a vertex without out-edges. Even indexed edges are the ones you add, odd ones are the ones you
+    // remove. If the head is even, that means we reached a sink in matroid_a and have an augmenting path.
+    assert(head % 2 == 0 || walk.size() % 2 == 0);
     std::vector<int> path;
-    //std::cerr << "Here's the walk: ";
-      //for (const auto& pair : walk) {
-        //std::cerr << pair.first << " , " << pair.second << " | ";
-      //}
-    if (reached_sink) {
-      for (const auto& pair : walk) {
-        path.push_back(pair.first); // Just adding the edges. Even indexed edges are the ones you add. Odd ones are the ones you remove. 
-      }
-      edges_to_delete = walk;
-      if (augmenting) {
-        //std::cerr << "Found an AUGMENTING path!" << std::endl;
-      } else {
-        //std::cerr << "Found an alternating path!" << std::endl;
-        assert(edges_to_delete.size() % 2 == 0); // DEBUGGING PURPOSES: This should be true.
-      }
-      list_of_paths.emplace_back(path);
-      tail = source; 
-    } else if (found_cycle) { 
-      //std::cerr << "Got a cycle instead." << std::endl;
-      bool found_head = sources[i] == head; // Will probably be false at first. 
-      for (const auto& pair : walk) {
-        if (found_head) {
-          edges_to_delete.push_back(pair);
-        }
-        else {
-          found_head = pair.second == head; 
-        }
-      }
-      assert(edges_to_delete.size() % 2 == 0); // DEBUGGING PURPOSES: This should be true.
-      i -= 1; // If we've found a cycle, we have to go back one step in the sources vector. 
-      tail = head; // error here????
+    path.reserve(walk.size());
+    if (!walk.empty()) {
+      ++next_edge[source];
     }
-    // Remove the edges in edges_to_delete from the exchange graph.
-    // print edges_to_delete
-    //std::cerr << "Edges to delete: ";
-    //for (const auto& pair : edges_to_delete) {
-    // std::cerr << pair.first << " , " << pair.second << " | ";
-    //}
-    //std::cerr << std::endl;
-
-    // Remove the edges from the exchange graph.
-    
-    for (const auto& pair : edges_to_delete) {
-      int edge = pair.first;
-      assert(exchange_graph[tail].count(edge) > 0); // Ensure edge exists
-      exchange_graph[tail].erase(edge);
-      tail = pair.second; 
+    walk_position[source] = -1;
+    for (int j = 0; j < walk.size(); j++) {
+      path.push_back(walk[j].first);
+      if (j + 1 < walk.size()) {
+        ++next_edge[walk[j].second];
+      }
+      walk_position[walk[j].second] = -1;
     }
+    list_of_paths.push_back(std::move(path));
   }
 
-  // DEBUGGING: Print out the paths.
-  //std::cerr << "Printing out the paths...: " << std::endl;
-  //for (const auto& path : list_of_paths) {
-  // std::cerr << "Path: ";
-    //for (const auto& e : path) {
-      //std::cerr << e << " ";
-    //}
-    //std::cerr << std::endl;
-  //}
-
-  // TESTING CODE: At the end, we can check that every vertex on the left hand side has in-degree = out-degree. That means all the sources are on the LHS.
-  //std::cout << "Size of list_of_paths: " << list_of_paths.size() << std::endl;
-  //std::cout << "Size of sources: " << sources.size() << std::endl;
-  std::map<int, int> lhs_in_degree;
-  for (int j = 0; j < matroid_a->GetGroupsNum(); j++) {
-    int rhs_vertex = 2 * j + 2; 
-    for (int e = 0; e < exchange_graph[rhs_vertex].size(); e++) {
-      int lhs_vertex = exchange_graph[rhs_vertex][e];
-      lhs_in_degree[lhs_vertex]++;
+  // TESTING CODE: At the end, we can check that every vertex on the left hand side has in-degree = out-degree. That
+  // means all the sources are on the LHS.
+  std::vector<int> lhs_in_degree(num_vertices, 0);
+  for (int j = 0; j < num_groups; j++) {
+    int rhs_vertex = 2 * j + 2;
+    for (int edge = next_edge[rhs_vertex]; edge < first_edge[rhs_vertex + 1]; edge++) {
+      lhs_in_degree[targets[edge]]++;
     }
   }
 
-  for (int i = 0; i < fairness_constraints->GetColorNum(); i++) {
+  for (int i = 0; i < num_colors; i++) {
     int lhs_vertex = 2 * i + 1;
-    int lhs_vertex_out_degree = exchange_graph[lhs_vertex].size();
+    int lhs_vertex_out_degree = first_edge[lhs_vertex + 1] - next_edge[lhs_vertex];
     if (lhs_vertex_out_degree - lhs_in_degree[lhs_vertex] != 0) {
       std::cerr << "Exchange Graph Error: The in-degree and out-degree of this vertex are not equal." << std::endl;
     }
@@ -530,18 +1155,74 @@ std::vector<std::vector<int>> ReturnPaths(PartitionMatroid* matroid_a, FairnessC
   std::cout << "Testing Done" << std::endl;
   std::cerr << std::endl;
 
-  return list_of_paths; 
+  return list_of_paths;
 }
 
-void ApproximateFairSubmodularMaximization(PartitionMatroid* matroid_a, FairnessConstraint* fairness_constraints, SubmodularFunction* sub_func_f, float epsilon) {
-  std::vector<int> set_P = FairMaxIntersection(matroid_a, fairness_constraints, sub_func_f->GetUniverse());
+FairPathDecomposition DecomposeFairPaths(PartitionMatroid* matroid_a, FairnessConstraint* fairness_constraints, SubmodularFunction* sub_func_f, const GreedyOptions& greedy_options, SubroutineCache* cache) {
+  const int64_t oracle_calls_before = SubmodularFunction::oracle_calls_;
+  FairPathDecomposition decomposition;
+  decomposition.set_P = cache != nullptr
+      ? cache->FairMaxIntersection(matroid_a, fairness_constraints, sub_func_f->GetUniverse())
+      : FairMaxIntersection(matroid_a, fairness_constraints, sub_func_f->GetUniverse());
   //std::cerr << "set_P made" << std::endl;
   matroid_a->Reset();
   std::unique_ptr<Matroid> upper_matroid = fairness_constraints->UpperBoundsToMatroid();
-  std::vector<int> set_Y = Greedy(matroid_a, upper_matroid.get(), sub_func_f, sub_func_f->GetUniverse());
+  decomposition.set_Y = cache != nullptr
+      ? cache->UpperBoundGreedy(matroid_a, upper_matroid.get(), sub_func_f, sub_func_f->GetUniverse(), greedy_options)
+      : Greedy(matroid_a, upper_matroid.get(), sub_func_f, sub_func_f->GetUniverse(), greedy_options);
   //std::cerr << "set_Y made" << std::endl;
-  std::vector<std::vector<int>> paths = ReturnPaths(matroid_a, fairness_constraints, sub_func_f, set_Y, set_P);
+  decomposition.paths = ReturnPaths(matroid_a, fairness_constraints, sub_func_f, decomposition.set_Y, decomposition.set_P);
   //std::cerr << "Paths made" << std::endl;
+  decomposition.oracle_calls = SubmodularFunction::oracle_calls_ - oracle_calls_before;
+  return decomposition;
+}
+
+std::vector<std::vector<int>> ApplyFairPathPrefixes(PartitionMatroid* matroid_a, FairnessConstraint* fairness_constraints, const FairPathDecomposition& decomposition, const std::vector<float>& epsilons) {
+  std::vector<std::vector<int>> paths = decomposition.paths;
+  RandomHandler::Shuffle(paths);
+  // Each epsilon rounds with the same draw as it would alone, and the generator ends up where it would after a
+  // single run.
+  const std::mt19937 generator_after_shuffle = RandomHandler::generator_;
+  std::vector<std::pair<int, int>> prefix_lengths;  // (number of paths, index of epsilon)
+  for (int i = 0; i < epsilons.size(); i++) {
+    RandomHandler::generator_ = generator_after_shuffle;
+    prefix_lengths.emplace_back(RandomHandler::RoundUpOrDown(paths.size() * (1 - epsilons[i])), i);
+  }
+  std::sort(prefix_lengths.begin(), prefix_lengths.end());
+
+  matroid_a->Reset();
+  fairness_constraints->Reset();
+  for (int element : decomposition.set_Y) {
+    matroid_a->Add(element);
+    fairness_constraints->Add(element);
+  }
+  std::vector<std::vector<int>> solutions(epsilons.size());
+  int num_applied = 0;
+  for (const std::pair<int, int>& prefix : prefix_lengths) {
+    for (; num_applied < prefix.first; num_applied++) {
+      const std::vector<int>& path = paths[num_applied];
+      for (int j = 0; j < path.size(); j++) {
+        if (j % 2 == 0) {
+          matroid_a->Add(path[j]);
+          fairness_constraints->Add(path[j]);
+        } else {
+          matroid_a->Remove(path[j]);
+          fairness_constraints->Remove(path[j]);
+        }
+      }
+      if (!matroid_a->CurrentIsFeasible() || !fairness_constraints->CurrentSatisfiesUpperBounds()) {
+        std::cerr << "Error!! The current solution is not feasible." << std::endl;
+      }
+    }
+    solutions[prefix.second] = matroid_a->GetCurrent();
+  }
+  return solutions;
+}
+
+void ApproximateFairSubmodularMaximization(PartitionMatroid* matroid_a, FairnessConstraint* fairness_constraints, SubmodularFunction* sub_func_f, float epsilon, const GreedyOptions& greedy_options, SubroutineCache* cache) {
+  FairPathDecomposition decomposition = DecomposeFairPaths(matroid_a, fairness_constraints, sub_func_f, greedy_options, cache);
+  const std::vector<int>& set_Y = decomposition.set_Y;
+  std::vector<std::vector<int>>& paths = decomposition.paths;
 
   matroid_a->Reset();
   fairness_constraints->Reset();
@@ -552,7 +1233,7 @@ void ApproximateFairSubmodularMaximization(PartitionMatroid* matroid_a, Fairness
     sub_func_f->Add(set_Y[i]);
   }
   assert(matroid_a->CurrentIsFeasible());
-  assert(fairness_constraints->UpperBoundsToMatroid()->IsFeasible(matroid_a->GetCurrent()));
+  assert(fairness_constraints->CurrentSatisfiesUpperBounds());
   // Randomly shuffle the paths.
   //std::cerr << "Initialized matroids to have set_Y." << std::endl;
   RandomHandler::Shuffle(paths);
@@ -598,12 +1279,16 @@ void ApproximateFairSubmodularMaximization(PartitionMatroid* matroid_a, Fairness
     //for (int k = 0; k < matroid_a->GetCurrent().size(); k++) {
       //std::cout << matroid_a->GetCurrent()[k] << " ";
     //}
-    if (!matroid_a->CurrentIsFeasible() || !fairness_constraints->UpperBoundsToMatroid()->IsFeasible(matroid_a->GetCurrent())) {
+    if (!matroid_a->CurrentIsFeasible() || !fairness_constraints->CurrentSatisfiesUpperBounds()) {
       std::cerr << "Error!! The current solution is not feasible." << std::endl;
     }
   }
-  std::cout << "Size of algorithm's set: " << matroid_a->GetCurrent().size() << std::endl;
-  std::cout << "Value of Greedy's set: " << sub_func_f->ObjectiveAndIncreaseOracleCall(set_Y) << std::endl;
-  std::cout << "Value of algorithm's set: " << sub_func_f->ObjectiveAndIncreaseOracleCall(matroid_a->GetCurrent()) << std::endl;
-  std::cout << "Value of Maximum Fair's set: " << sub_func_f->ObjectiveAndIncreaseOracleCall(set_P) << std::endl;
+  PrintFairPathSummary(sub_func_f, decomposition, matroid_a->GetCurrent());
+}
+
+void PrintFairPathSummary(SubmodularFunction* sub_func_f, const FairPathDecomposition& decomposition, const std::vector<int>& solution) {
+  std::cout << "Size of algorithm's set: " << solution.size() << std::endl;
+  std::cout << "Value of Greedy's set: " << sub_func_f->ObjectiveAndIncreaseOracleCall(decomposition.set_Y) << std::endl;
+  std::cout << "Value of algorithm's set: " << sub_func_f->ObjectiveAndIncreaseOracleCall(solution) << std::endl;
+  std::cout << "Value of Maximum Fair's set: " << sub_func_f->ObjectiveAndIncreaseOracleCall(decomposition.set_P) << std::endl;
 }
@@ -4,7 +4,13 @@
 #ifndef FAIR_SUBMODULAR_MATROID_MATROID_INTERSECTION_H_
 #define FAIR_SUBMODULAR_MATROID_MATROID_INTERSECTION_H_
 
+#include <stdint.h>
+
+#include <memory>
+#include <queue>
 #include <set>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "matroid.h"
@@ -12,12 +18,24 @@
 #include "submodular_function.h"
 #include "partition_matroid.h"
 
+class SubroutineCache;
+
 // Constructs a maximum cardinality set in the intersections of two matroids.
 // The solution is constructed in place in both input matroid objects.
 void MaxIntersection(Matroid* matroid_a,
                      Matroid* matroid_b,
                      const std::vector<int>& elements);
 
+// Same as above, but starts from the elements of `start` (a subset of
+// `elements`) and only augments from there. Elements of `start` that are not
+// independent in both matroids together with the previous ones are skipped,
+// so any set can be passed, but this only saves work if `start` is a common
+// independent set, e.g. the solution for smaller bounds.
+void MaxIntersection(Matroid* matroid_a,
+                     Matroid* matroid_b,
+                     const std::vector<int>& elements,
+                     const std::vector<int>& start);
+
  // Constructs a *fair* maximum cardinality set in the intersections of two matroids.
 std::vector<int> FairMaxIntersection(Matroid* matroid_a,
                       FairnessConstraint* fairness_constraint,
@@ -28,11 +46,109 @@ void SubMaxIntersectionSwapping(Matroid* matroid_a,
                         SubmodularFunction* sub_func_f,
                         const std::vector<int>& universe);
 
+// How Greedy() finds the element to add in each step. The exact variants
+// return the same solution, including under exact ties in the gains (the
+// element that comes first in the universe wins); they only differ in the
+// number of oracle calls. The approximate variants trade a factor depending
+// on GreedyOptions::epsilon in the guarantee for fewer oracle calls.
+enum GreedyEvaluation {
+  EXACT_GREEDY = 0, // evaluates every feasible element in every step
+  LAZY_GREEDY = 1, // re-evaluates only the top of a heap of stale gains
+  STOCHASTIC_GREEDY = 2, // best of (n / k) log(1 / epsilon) random samples
+  THRESHOLD_GREEDY = 3 // thresholds decreasing by factors of (1 - epsilon)
+};
+
+struct GreedyOptions {
+  GreedyEvaluation evaluation = LAZY_GREEDY;
+
+  // Accuracy of the approximate variants, in (0, 1).
+  double epsilon = 0.1;
+
+  // Number of threads computing batches of gains, each on its own clone of
+  // the function (0 = NumThreads()). Does not change the solution.
+  int num_threads = 1;
+};
+
+// Returns a description of the options for algorithm names, e.g.
+// "stochastic greedy, epsilon=0.100000", or an empty string for the exact
+// variants (so that the names of the algorithms using them do not change).
+std::string GreedyOptionsToString(const GreedyOptions& options);
+
 // Runs the Greedy algorithm to choose feasible elements to add
 std::vector<int> Greedy(Matroid* matroid_a,
                         Matroid* matroid_b,
                         SubmodularFunction* sub_func_f,
-                        const std::vector<int>& universe);
+                        const std::vector<int>& universe,
+                        const GreedyOptions& options = GreedyOptions());
+
+// Runs Greedy() for a sequence of growing constraints, e.g. the bounds of
+// increasing ranks, continuing from the solution of the previous run instead
+// of starting from the empty set. The function state and the lazy heap of
+// stale gains are kept between runs, so each run only pays for the steps
+// that the larger bounds allow.
+//
+// The result may differ from a cold start: an element that could not be
+// added in some step under the old bounds may be addable under the new ones
+// and would then have competed in that step. Run() detects this (without
+// oracle calls, and conservatively, i.e., it may report a difference that
+// would not actually change the choice).
+class GreedyContinuation {
+ public:
+  // Uses a copy of sub_func_f (which it resets) over `universe`. The
+  // evaluation is always LAZY_GREEDY, which picks the same elements as
+  // EXACT_GREEDY; only options.num_threads is used.
+  GreedyContinuation(const SubmodularFunction& sub_func_f,
+                     const std::vector<int>& universe,
+                     const GreedyOptions& options);
+
+  // Resets both matroids, adds the previous solution and continues greedy
+  // from there; the solution is left in the matroids. Every set independent
+  // in the matroids of the previous run must be independent in these ones.
+  // If the previous solution is not, greedy starts from the empty set again.
+  // Returns true if the solution is the one Greedy() returns from scratch.
+  bool Run(Matroid* matroid_a, Matroid* matroid_b);
+
+  // Returns the universe passed to the constructor.
+  const std::vector<int>& GetUniverse() const;
+
+ private:
+  // An element that could not be added to the solution.
+  struct Blocked {
+    // Position in universe_.
+    int pos;
+    // Upper bound on its gain (infinity if never computed).
+    double bound;
+    // Size of the solution when it could not be added.
+    int step;
+  };
+
+  // Starts greedy from the empty set on the (reset) matroids.
+  void Start(Matroid* matroid_a, Matroid* matroid_b);
+
+  std::unique_ptr<SubmodularFunction> sub_func_f_;
+  std::vector<int> universe_;
+  GreedyOptions options_;
+
+  // The current solution, in the order it was added.
+  std::vector<int> solution_;
+
+  // (gain bound, -position in universe), as in LAZY_GREEDY.
+  std::priority_queue<std::pair<double, int>> bounds_;
+
+  // evaluated_in_step_[pos] = the step in which the bound of universe_[pos]
+  // was last computed.
+  std::vector<int> evaluated_in_step_;
+
+  // Elements that could not be added so far.
+  std::vector<Blocked> blocked_;
+
+  // Whether Run() was called before.
+  bool started_ = false;
+
+  // Whether some earlier run already differed from a cold start. Then all
+  // later ones may differ as well.
+  bool diverged_ = false;
+};
 
 // Returns a set of augmenting paths w.r.t set_Y and the intersection of a partition matroid and a fairness constraint.
 std::vector<std::vector<int>> ReturnPaths(PartitionMatroid* matroid_a,
@@ -42,8 +158,48 @@ std::vector<std::vector<int>> ReturnPaths(PartitionMatroid* matroid_a,
                         const std::vector<int>& set_P);
 
 
+// The deterministic part of ApproximateFairSubmodularMaximization() (unless
+// the greedy variant is randomized): a maximum fair set P, the greedy
+// solution Y under the upper bounds, and the paths returned by ReturnPaths().
+struct FairPathDecomposition {
+  std::vector<int> set_P;
+  std::vector<int> set_Y;
+  std::vector<std::vector<int>> paths;
+  // Oracle calls made (or charged by the cache) while computing the above.
+  int64_t oracle_calls = 0;
+};
+
+// Computes P, Y and the paths as ApproximateFairSubmodularMaximization() does,
+// reusing P and Y from `cache` if it is not null.
+FairPathDecomposition DecomposeFairPaths(
+    PartitionMatroid* matroid_a, FairnessConstraint* fairness_constraints,
+    SubmodularFunction* sub_func_f, const GreedyOptions& greedy_options,
+    SubroutineCache* cache = nullptr);
+
+// Shuffles the paths once and, for each epsilon, applies the first
+// (1 - epsilon) fraction of them (randomly rounded) to Y, i.e., computes the
+// solutions of ApproximateFairSubmodularMaximization() for all epsilons in
+// one pass. The random draws for each epsilon are the ones a run for that
+// epsilon alone would make, so the solutions are the same. Returns one
+// solution per epsilon; leaves the matroid and the fairness constraint in an
+// unspecified state.
+std::vector<std::vector<int>> ApplyFairPathPrefixes(
+    PartitionMatroid* matroid_a, FairnessConstraint* fairness_constraints,
+    const FairPathDecomposition& decomposition,
+    const std::vector<float>& epsilons);
+
+// Prints the size of the solution and the values of Y, the solution and P, as
+// ApproximateFairSubmodularMaximization() does at the end. Makes three oracle
+// calls.
+void PrintFairPathSummary(SubmodularFunction* sub_func_f,
+                          const FairPathDecomposition& decomposition,
+                          const std::vector<int>& solution);
+
 void ApproximateFairSubmodularMaximization(PartitionMatroid* matroid_a,
                         FairnessConstraint* fairness_constraints,
                         SubmodularFunction* sub_func_f,
-                        float epsilon);  
+                        float epsilon,
+                        const GreedyOptions& greedy_options =
+                            GreedyOptions(),
+                        SubroutineCache* cache = nullptr);  
 #endif  
@@ -3,6 +3,8 @@
 
 #include "movies_data.h"
 
+#include <stdint.h>
+
 #include <algorithm>
 #include <cassert>
 #include <fstream>
@@ -47,17 +49,42 @@ std::vector<std::vector<double>> Transpose(
   return res;
 }
 
-std::vector<std::vector<double>> ComputeMovieMovieSimilarityMatrix(
+// Side of the square blocks in which V * V^T is computed.
+constexpr int kSimilarityBlockSize = 64;
+
+// Returns V * V^T as a row-major m x m matrix. Only blocks on or above the
+// diagonal are computed (each is mirrored), one block-row per task.
+std::vector<double> ComputeMovieMovieSimilarityMatrix(
     const std::vector<std::vector<double>>& V) {
-  std::vector<std::vector<double>> res(V.size(), std::vector<double>(V.size()));
-  for (int i = 0; i < V.size(); ++i) {
-    for (int j = 0; j < V.size(); ++j) {
-      res[i][j] = 0.0;
-      for (int k = 0; k < V[0].size(); ++k) {
-        res[i][j] += V[i][k] * V[j][k];
+  const int m = V.size();
+  const int r = V[0].size();
+  std::vector<double> flat_v;
+  flat_v.reserve(static_cast<int64_t>(m) * r);
+  for (const std::vector<double>& row : V) {
+    flat_v.insert(flat_v.end(), row.begin(), row.end());
+  }
+  std::vector<double> res(static_cast<int64_t>(m) * m);
+  const int num_blocks = (m + kSimilarityBlockSize - 1) / kSimilarityBlockSize;
+  ParallelFor(num_blocks, [&](int block_i) {
+    const int i_begin = block_i * kSimilarityBlockSize;
+    const int i_end = std::min(m, i_begin + kSimilarityBlockSize);
+    for (int block_j = block_i; block_j < num_blocks; ++block_j) {
+      const int j_begin = block_j * kSimilarityBlockSize;
+      const int j_end = std::min(m, j_begin + kSimilarityBlockSize);
+      for (int i = i_begin; i < i_end; ++i) {
+        const double* v_i = flat_v.data() + static_cast<int64_t>(i) * r;
+        for (int j = std::max(i, j_begin); j < j_end; ++j) {
+          const double* v_j = flat_v.data() + static_cast<int64_t>(j) * r;
+          double dot = 0.0;
+          for (int k = 0; k < r; ++k) {
+            dot += v_i[k] * v_j[k];
+          }
+          res[static_cast<int64_t>(i) * m + j] = dot;
+          res[static_cast<int64_t>(j) * m + i] = dot;
+        }
       }
     }
-  }
+  });
   return res;
 }
 
@@ -156,7 +183,11 @@ const std::map<int, int>& MoviesData::GetMovieIdToYearBandMap() const {
 }
 
 double MoviesData::GetMovieMovieSimilarity(int movie1, int movie2) const {
-  return vvt_[movie1][movie2];
+  return vvt_[static_cast<int64_t>(movie1) * v_.size() + movie2];
+}
+
+const double* MoviesData::GetMovieMovieSimilarityRow(int movie) const {
+  return vvt_.data() + static_cast<int64_t>(movie) * v_.size();
 }
 
 double MoviesData::GetUserMovieScore(int user, int movie) const {
@@ -18,6 +18,9 @@ class MoviesData {
   // Returns the dot product of two movie vectors.
   double GetMovieMovieSimilarity(int movie1, int movie2) const;
 
+  // Returns the similarities of a movie to all movies (a row of V * V^T).
+  const double* GetMovieMovieSimilarityRow(int movie) const;
+
   // Returns the dot product of a user vector with a movie vector.
   double GetUserMovieScore(int user, int movie) const;
 
@@ -71,8 +74,8 @@ class MoviesData {
 
   // Matrices U and V.
   std::vector<std::vector<double>> u_, v_;
-  // V * V^T
-  std::vector<std::vector<double>> vvt_;
+  // V * V^T, row-major (movies x movies).
+  std::vector<double> vvt_;
   // Maps movie id to genre id.
   std::map<int, int> movie_id_to_genre_id_;
   // Maps movie id to year band (as described in paper).
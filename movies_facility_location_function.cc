@@ -5,55 +5,70 @@
 
 #include <algorithm>
 #include <cassert>
-#include <functional>
+#include <limits>
 #include <memory>
-#include <set>
 #include <string>
 #include <vector>
 
 #include "movies_data.h"
 
-MoviesFacilityLocationFunction::MoviesFacilityLocationFunction()
-    : max_sim_(MoviesData::GetInstance().GetNumberOfMovies(), {0.}) {}
+namespace {
+
+// Marks an empty second-best slot (-1 is the 0.0 floor).
+constexpr int kNoMovie = -2;
+
+}  // namespace
+
+MoviesFacilityLocationFunction::MoviesFacilityLocationFunction() { Reset(); }
 
 void MoviesFacilityLocationFunction::Reset() {
-  for (auto& ref : max_sim_) {
-    ref = {0.};
-  }
+  const int no_movies = MoviesData::GetInstance().GetNumberOfMovies();
+  best_sim_.assign(no_movies, 0.);
+  second_sim_.assign(no_movies, -std::numeric_limits<double>::infinity());
+  best_movie_.assign(no_movies, -1);
+  second_movie_.assign(no_movies, kNoMovie);
+  movies_.clear();
 }
 
 double MoviesFacilityLocationFunction::Delta(int movie) {
+  const double* sim =
+      MoviesData::GetInstance().GetMovieMovieSimilarityRow(movie);
+  const double* best = best_sim_.data();
+  const int no_movies = best_sim_.size();
   double res = 0.;
-  const int noMovies = MoviesData::GetInstance().GetNumberOfMovies();
-  for (int i = 0; i < noMovies; ++i) {
-    res += std::max(
-        0.0, MoviesData::GetInstance().GetMovieMovieSimilarity(movie, i) -
-                 *max_sim_[i].begin());
+  for (int i = 0; i < no_movies; ++i) {
+    res += std::max(0.0, sim[i] - best[i]);
   }
   return res;
 }
 
+void MoviesFacilityLocationFunction::DeltaBatch(
+    const std::vector<int>& elements, std::vector<double>* deltas) {
+  // The state is contiguous, so each movie is a single pass over one row.
+  for (int j = 0; j < elements.size(); ++j) {
+    (*deltas)[j] = Delta(elements[j]);
+  }
+}
+
 void MoviesFacilityLocationFunction::Remove(int movie) {
-  const int no_movies = MoviesData::GetInstance().GetNumberOfMovies();
+  auto it = std::find(movies_.begin(), movies_.end(), movie);
+  assert(it != movies_.end());
+  movies_.erase(it);
+  const int no_movies = best_sim_.size();
   for (int i = 0; i < no_movies; ++i) {
-    auto it = max_sim_[i].find(
-        MoviesData::GetInstance().GetMovieMovieSimilarity(movie, i));
-    assert(it != max_sim_[i].end());
-    max_sim_[i].erase(it);
+    if (best_movie_[i] == movie || second_movie_[i] == movie) {
+      RecomputeMostSimilar(i);
+    }
   }
 }
 
 double MoviesFacilityLocationFunction::RemovalDelta(int movie) {
   double val = 0.;
-  const int noMovies = MoviesData::GetInstance().GetNumberOfMovies();
-  for (int i = 0; i < noMovies; ++i) {
-    const double eval =
-        MoviesData::GetInstance().GetMovieMovieSimilarity(movie, i);
-    auto it = max_sim_[i].begin();
-    if (*it == eval) {
+  const int no_movies = best_sim_.size();
+  for (int i = 0; i < no_movies; ++i) {
+    if (best_movie_[i] == movie) {
       // Movie has the maximum currently, so we look at the second-best.
-      ++it;
-      val += eval - *it;
+      val += best_sim_[i] - second_sim_[i];
     }  // else: movie is not the maximum, so removing it won't change things.
   }
   return val;
@@ -62,41 +77,74 @@ double MoviesFacilityLocationFunction::RemovalDelta(int movie) {
 // Not necessary, but overloaded for efficiency
 double MoviesFacilityLocationFunction::RemoveAndIncreaseOracleCall(int movie) {
   ++oracle_calls_;
+  auto it = std::find(movies_.begin(), movies_.end(), movie);
+  assert(it != movies_.end());
+  movies_.erase(it);
   double val = 0.;
-  const int no_movies = MoviesData::GetInstance().GetNumberOfMovies();
+  const int no_movies = best_sim_.size();
   for (int i = 0; i < no_movies; ++i) {
-    const double before = *max_sim_[i].begin();
-    auto it = max_sim_[i].find(
-        MoviesData::GetInstance().GetMovieMovieSimilarity(movie, i));
-    assert(it != max_sim_[i].end());
-    max_sim_[i].erase(it);
-    const double after = *max_sim_[i].begin();
-    val += before - after;
+    if (best_movie_[i] == movie || second_movie_[i] == movie) {
+      const double before = best_sim_[i];
+      RecomputeMostSimilar(i);
+      val += before - best_sim_[i];
+    }
   }
   return val;
 }
 
 void MoviesFacilityLocationFunction::Add(int movie) {
-  const int no_movies = MoviesData::GetInstance().GetNumberOfMovies();
+  movies_.push_back(movie);
+  const double* sim =
+      MoviesData::GetInstance().GetMovieMovieSimilarityRow(movie);
+  const int no_movies = best_sim_.size();
   for (int i = 0; i < no_movies; ++i) {
-    max_sim_[i].insert(
-        MoviesData::GetInstance().GetMovieMovieSimilarity(movie, i));
+    if (sim[i] > best_sim_[i]) {
+      second_sim_[i] = best_sim_[i];
+      second_movie_[i] = best_movie_[i];
+      best_sim_[i] = sim[i];
+      best_movie_[i] = movie;
+    } else if (sim[i] > second_sim_[i]) {
+      second_sim_[i] = sim[i];
+      second_movie_[i] = movie;
+    }
+  }
+}
+
+void MoviesFacilityLocationFunction::RecomputeMostSimilar(int i) {
+  // The similarity is symmetric, so row i holds sim(j, i) for all j.
+  const double* sim = MoviesData::GetInstance().GetMovieMovieSimilarityRow(i);
+  best_sim_[i] = 0.;
+  best_movie_[i] = -1;
+  second_sim_[i] = -std::numeric_limits<double>::infinity();
+  second_movie_[i] = kNoMovie;
+  for (int movie : movies_) {
+    if (sim[movie] > best_sim_[i]) {
+      second_sim_[i] = best_sim_[i];
+      second_movie_[i] = best_movie_[i];
+      best_sim_[i] = sim[movie];
+      best_movie_[i] = movie;
+    } else if (sim[movie] > second_sim_[i]) {
+      second_sim_[i] = sim[movie];
+      second_movie_[i] = movie;
+    }
   }
 }
 
 double MoviesFacilityLocationFunction::Objective(
     const std::vector<int>& elements) const {
   // stateless implementation
-  const int noMovies = MoviesData::GetInstance().GetNumberOfMovies();
+  const MoviesData& data = MoviesData::GetInstance();
+  const int noMovies = data.GetNumberOfMovies();
+  std::vector<double> max_sim(noMovies, 0.);
+  for (int movie : elements) {
+    const double* sim = data.GetMovieMovieSimilarityRow(movie);
+    for (int i = 0; i < noMovies; ++i) {
+      max_sim[i] = std::max(max_sim[i], sim[i]);
+    }
+  }
   double res = 0.;
   for (int i = 0; i < noMovies; ++i) {
-    double max_sim_i = 0.;
-    for (int movie : elements) {
-      max_sim_i =
-          std::max(max_sim_i,
-                   MoviesData::GetInstance().GetMovieMovieSimilarity(movie, i));
-    }
-    res += max_sim_i;
+    res += max_sim[i];
   }
   return res;
 }
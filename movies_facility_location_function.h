@@ -4,9 +4,7 @@
 #ifndef FAIR_SUBMODULAR_MATROID_MOVIES_FACILITY_LOCATION_FUNCTION_H_
 #define FAIR_SUBMODULAR_MATROID_MOVIES_FACILITY_LOCATION_FUNCTION_H_
 
-#include <functional>
 #include <memory>
-#include <set>
 #include <string>
 #include <vector>
 
@@ -42,6 +40,10 @@ class MoviesFacilityLocationFunction : public SubmodularFunction {
   // Computes f(S u {e}) - f(S).
   double Delta(int e) override;
 
+  // Computes f(S u {e}) - f(S) for a batch of movies.
+  void DeltaBatch(const std::vector<int>& elements,
+                  std::vector<double>* deltas) override;
+
   // Computes f(S) - f(S - e).
   double RemovalDelta(int e) override;
 
@@ -52,8 +54,19 @@ class MoviesFacilityLocationFunction : public SubmodularFunction {
   friend class MoviesMixedUtilityFunction;
 
  private:
-  // max_sim[i] = {0.0} u { sim(i,j) : j in S }
-  std::vector<std::multiset<double, std::greater<double>>> max_sim_;
+  // Recomputes the best and second-best similarities of movie i from the
+  // current set.
+  void RecomputeMostSimilar(int i);
+
+  // For every movie i, the two largest values (and the movies attaining them,
+  // -1 for the 0.0 floor) among {0.0} u { sim(i,j) : j in S }.
+  std::vector<double> best_sim_;
+  std::vector<double> second_sim_;
+  std::vector<int> best_movie_;
+  std::vector<int> second_movie_;
+
+  // The current set S.
+  std::vector<int> movies_;
 };
 
 #endif  // FAIR_SUBMODULAR_MATROID_MOVIES_FACILITY_LOCATION_FUNCTION_H_
@@ -21,6 +21,14 @@ double MoviesMixedUtilityFunction::Delta(int movie) {
   return alpha_ * mf_.Delta(movie) + (1 - alpha_) * mu_.Delta(movie);
 }
 
+void MoviesMixedUtilityFunction::DeltaBatch(const std::vector<int>& movies,
+                                            std::vector<double>* deltas) {
+  mf_.DeltaBatch(movies, deltas);
+  for (int i = 0; i < movies.size(); ++i) {
+    (*deltas)[i] = alpha_ * (*deltas)[i] + (1 - alpha_) * mu_.Delta(movies[i]);
+  }
+}
+
 double MoviesMixedUtilityFunction::RemovalDelta(int movie) {
   return alpha_ * mf_.RemovalDelta(movie) +
          (1 - alpha_) * mu_.RemovalDelta(movie);
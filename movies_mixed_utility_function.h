@@ -44,6 +44,10 @@ class MoviesMixedUtilityFunction : public SubmodularFunction {
   // Computes f(S u {e}) - f(S).
   double Delta(int movie) override;
 
+  // Computes f(S u {e}) - f(S) for a batch of movies.
+  void DeltaBatch(const std::vector<int>& movies,
+                  std::vector<double>* deltas) override;
+
   // Computes f(S).
   double Objective(const std::vector<int>& movies) const override;
 
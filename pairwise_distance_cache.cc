@@ -0,0 +1,96 @@
+// Copyright 2025 The Authors (see AUTHORS file)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "pairwise_distance_cache.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+PairwiseDistanceCache::PairwiseDistanceCache(
+    const std::vector<std::vector<double>>& points,
+    int64_t memory_budget_bytes)
+    : n_(points.size()), d_(points.empty() ? 0 : points[0].size()) {
+  points_.reserve(static_cast<int64_t>(n_) * d_);
+  for (const std::vector<double>& point : points) {
+    assert(point.size() == d_);
+    points_.insert(points_.end(), point.begin(), point.end());
+  }
+
+  const int64_t row_bytes = static_cast<int64_t>(n_) * sizeof(double);
+  if (row_bytes * n_ <= memory_budget_bytes) {
+    auto dense =
+        std::make_shared<std::vector<double>>(static_cast<int64_t>(n_) * n_);
+    // Only the upper triangle is computed; the distance is symmetric.
+    for (int x = 0; x < n_; ++x) {
+      double* row = dense->data() + static_cast<int64_t>(x) * n_;
+      for (int y = x; y < n_; ++y) {
+        row[y] = ComputeDistance(x, y);
+        (*dense)[static_cast<int64_t>(y) * n_ + x] = row[y];
+      }
+    }
+    dense_ = std::move(dense);
+    std::cerr << "distance cache: dense, " << row_bytes * n_ / (1 << 20)
+              << " MB" << std::endl;
+  } else {
+    max_resident_rows_ = static_cast<int>(
+        std::max<int64_t>(1, memory_budget_bytes / row_bytes));
+    rows_.resize(n_);
+    resident_position_.resize(n_);
+    std::cerr << "distance cache: by row, at most " << max_resident_rows_
+              << " of " << n_ << " rows resident" << std::endl;
+  }
+}
+
+bool PairwiseDistanceCache::IsDense() const { return dense_ != nullptr; }
+
+double PairwiseDistanceCache::Distance(int x, int y) const {
+  if (dense_) {
+    return (*dense_)[static_cast<int64_t>(x) * n_ + y];
+  }
+  return ComputeDistance(x, y);
+}
+
+PairwiseDistanceCache::Row PairwiseDistanceCache::GetRow(int x) const {
+  if (dense_) {
+    return Row(dense_, dense_->data() + static_cast<int64_t>(x) * n_);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (rows_[x]) {
+    resident_rows_.splice(resident_rows_.end(), resident_rows_,
+                          resident_position_[x]);
+  } else {
+    if (resident_rows_.size() >= max_resident_rows_) {
+      // Holders of the evicted row keep it alive.
+      rows_[resident_rows_.front()].reset();
+      resident_rows_.pop_front();
+    }
+    auto row = std::make_shared<std::vector<double>>(n_);
+    ComputeRow(x, row->data());
+    rows_[x] = std::move(row);
+    resident_position_[x] =
+        resident_rows_.insert(resident_rows_.end(), x);
+  }
+  return Row(rows_[x], rows_[x]->data());
+}
+
+double PairwiseDistanceCache::ComputeDistance(int x, int y) const {
+  const double* px = points_.data() + static_cast<int64_t>(x) * d_;
+  const double* py = points_.data() + static_cast<int64_t>(y) * d_;
+  double answer = 0;
+  for (int i = 0; i < d_; i++) {
+    answer += (px[i] - py[i]) * (px[i] - py[i]);
+  }
+  return answer;
+}
+
+void PairwiseDistanceCache::ComputeRow(int x, double* out) const {
+  for (int y = 0; y < n_; ++y) {
+    out[y] = ComputeDistance(x, y);
+  }
+}
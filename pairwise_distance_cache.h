@@ -0,0 +1,89 @@
+// Copyright 2025 The Authors (see AUTHORS file)
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef FAIR_SUBMODULAR_MATROID_PAIRWISE_DISTANCE_CACHE_H_
+#define FAIR_SUBMODULAR_MATROID_PAIRWISE_DISTANCE_CACHE_H_
+
+#include <stdint.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Squared Euclidean distances between all pairs of a fixed set of points,
+// stored within a memory budget. If the full n x n matrix fits, it is computed
+// once up front; otherwise single rows are computed on demand, and the least
+// recently used rows are dropped once the budget is reached. The values are
+// bit-identical to computing the distance directly.
+
+// Thread-safe; meant to be shared (e.g. via shared_ptr) between clones of the
+// same function.
+
+class PairwiseDistanceCache {
+ public:
+  // A row of the distance matrix. Keeps the underlying storage alive, so it
+  // stays valid even if the row is evicted meanwhile.
+  class Row {
+   public:
+    double operator[](int y) const { return row_[y]; }
+
+   private:
+    friend class PairwiseDistanceCache;
+    Row(std::shared_ptr<const std::vector<double>> storage, const double* row)
+        : storage_(std::move(storage)), row_(row) {}
+
+    std::shared_ptr<const std::vector<double>> storage_;
+    const double* row_;
+  };
+
+  PairwiseDistanceCache(const std::vector<std::vector<double>>& points,
+                        int64_t memory_budget_bytes);
+
+  // Forbids copying.
+  PairwiseDistanceCache(const PairwiseDistanceCache&) = delete;
+  PairwiseDistanceCache& operator=(const PairwiseDistanceCache&) = delete;
+
+  // Returns whether the full matrix is held in memory.
+  bool IsDense() const;
+
+  // Returns the squared distance between points x and y.
+  double Distance(int x, int y) const;
+
+  // Returns row x, i.e., the squared distances from x to all points.
+  Row GetRow(int x) const;
+
+ private:
+  // Computes the squared distance between points x and y from coordinates.
+  double ComputeDistance(int x, int y) const;
+
+  // Computes row x into `out`.
+  void ComputeRow(int x, double* out) const;
+
+  // Number of points and dimensions.
+  int n_;
+  int d_;
+
+  // Coordinates, row-major (n_ x d_).
+  std::vector<double> points_;
+
+  // The full matrix in dense mode, nullptr otherwise.
+  std::shared_ptr<const std::vector<double>> dense_;
+
+  // Maximum number of resident rows otherwise.
+  int max_resident_rows_ = 0;
+
+  // Guards the row state below.
+  mutable std::mutex mutex_;
+
+  // rows_[x] holds row x, or is nullptr if the row is not resident.
+  mutable std::vector<std::shared_ptr<const std::vector<double>>> rows_;
+
+  // Resident rows, least recently used first, and the position of each
+  // resident row in that list.
+  mutable std::list<int> resident_rows_;
+  mutable std::vector<std::list<int>::iterator> resident_position_;
+};
+
+#endif  // FAIR_SUBMODULAR_MATROID_PAIRWISE_DISTANCE_CACHE_H_
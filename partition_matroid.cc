@@ -3,73 +3,106 @@
 
 #include "partition_matroid.h"
 
+#include <algorithm>
 #include <cassert>
 #include <map>
 #include <memory>
-#include <set>
+#include <utility>
 #include <vector>
 
 #include "matroid.h"
+#include "utilities.h"
 
 PartitionMatroid::PartitionMatroid(const std::map<int, int>& groups_map,
                                    const std::vector<int>& ks)
-    : groups_map_(groups_map),
-      ks_(ks),
-      num_groups_(ks.size()),
-      current_grpcards_(num_groups_, 0) {}
+    : ks_(ks), num_groups_(ks.size()), group_members_(num_groups_) {
+  if (!groups_map.empty()) {
+    if (groups_map.begin()->first < 0) {
+      Fail("partition matroid elements must be non-negative");
+    }
+    groups_.assign(groups_map.rbegin()->first + 1, -1);
+  }
+  for (const auto& [element, group] : groups_map) {
+    if (group < 0 || group >= num_groups_) {
+      Fail("partition matroid group out of range");
+    }
+    groups_[element] = group;
+  }
+}
+
+PartitionMatroid::PartitionMatroid(std::vector<int> groups,
+                                   std::vector<int> ks)
+    : groups_(std::move(groups)),
+      ks_(std::move(ks)),
+      num_groups_(ks_.size()),
+      group_members_(num_groups_) {}
 
 void PartitionMatroid::Reset() {
-  for (int i = 0; i < current_grpcards_.size(); ++i) {
-    current_grpcards_[i] = 0;
+  for (std::vector<int>& members : group_members_) {
+    members.clear();
   }
-  current_set_.clear();
+  num_groups_over_bound_ = 0;
+  current_set_.Clear();
 }
 
 bool PartitionMatroid::CanAdd(int element) const {
-  assert(!current_set_.count(element));
-  int elt_group = groups_map_.at(element);
-  return current_grpcards_[elt_group] + 1 <= ks_[elt_group];
+  assert(!current_set_.Contains(element));
+  const int elt_group = GroupOf(element);
+  return group_members_[elt_group].size() < ks_[elt_group];
 }
 
 bool PartitionMatroid::CanSwap(int element, int swap) const {
-  assert(!current_set_.count(element));
-  assert(current_set_.count(swap));
-  return CanAdd(element) || groups_map_.at(element) == groups_map_.at(swap);
+  assert(!current_set_.Contains(element));
+  assert(current_set_.Contains(swap));
+  return CanAdd(element) || GroupOf(element) == GroupOf(swap);
 }
 
 std::vector<int> PartitionMatroid::GetAllSwaps(int element) const {
-  if (CanAdd(element)) {
-    return GetCurrent();
+  if (!CanAdd(element)) {
+    return group_members_[GroupOf(element)];
   }
-  const int group = groups_map_.at(element);
+  // The group lists are sorted; merge them.
   std::vector<int> all_swaps;
-  for (int swap : current_set_) {
-    if (groups_map_.at(swap) == group) {
-      all_swaps.push_back(swap);
+  all_swaps.reserve(current_set_.size());
+  std::vector<int64_t> bounds = {0};
+  for (const std::vector<int>& members : group_members_) {
+    if (!members.empty()) {
+      all_swaps.insert(all_swaps.end(), members.begin(), members.end());
+      bounds.push_back(all_swaps.size());
     }
   }
+  MergeSortedRuns(all_swaps, bounds);
   return all_swaps;
 }
 
 void PartitionMatroid::Add(int element) {
-  assert(!current_set_.count(element));
-  int elt_group = groups_map_.at(element);
-  current_grpcards_[elt_group]++;
-  current_set_.insert(element);
+  assert(!current_set_.Contains(element));
+  const int elt_group = GroupOf(element);
+  std::vector<int>& members = group_members_[elt_group];
+  members.insert(std::lower_bound(members.begin(), members.end(), element),
+                 element);
+  if (members.size() == ks_[elt_group] + 1) {
+    num_groups_over_bound_++;
+  }
+  current_set_.Insert(element);
 }
 
 void PartitionMatroid::Remove(int element) {
-  assert(current_set_.count(element));
-  int elt_group = groups_map_.at(element);
-  current_grpcards_[elt_group]--;
-  current_set_.erase(element);
+  assert(current_set_.Contains(element));
+  const int elt_group = GroupOf(element);
+  std::vector<int>& members = group_members_[elt_group];
+  if (members.size() == ks_[elt_group] + 1) {
+    num_groups_over_bound_--;
+  }
+  members.erase(std::lower_bound(members.begin(), members.end(), element));
+  current_set_.Erase(element);
 }
 
 bool PartitionMatroid::IsFeasible(const std::vector<int>& elements) const {
   std::vector<int> grpcards = std::vector<int>(num_groups_, 0);
   int elt_group;
   for (int elt : elements) {
-    elt_group = groups_map_.at(elt);
+    elt_group = GroupOf(elt);
     grpcards[elt_group]++;
     if (grpcards[elt_group] > ks_[elt_group]) return false;
   }
@@ -77,28 +110,51 @@ bool PartitionMatroid::IsFeasible(const std::vector<int>& elements) const {
 }
 
 bool PartitionMatroid::CurrentIsFeasible() const {
-  for (int i = 0; i < num_groups_; ++i) {
-    if (current_grpcards_[i] > ks_[i]) {
-      return false;
-    }
-  }
-  return true;
+  return num_groups_over_bound_ == 0;
 }
 
-std::vector<int> PartitionMatroid::GetCurrent() const {
-  return std::vector<int>(current_set_.begin(), current_set_.end());
+const std::vector<int>& PartitionMatroid::CurrentMembers() const {
+  return current_set_.members();
 }
 
 int PartitionMatroid::GetGroup(int element) const {
-  return groups_map_.at(element);
+  return GroupOf(element);
 }
 
 int PartitionMatroid::GetGroupsNum() const {
   return num_groups_;
 }
 
+int PartitionMatroid::GetGroupBound(int group) const {
+  return ks_[group];
+}
+
 bool PartitionMatroid::InCurrent(int element) const {
-  return current_set_.count(element);
+  return current_set_.Contains(element);
+}
+
+std::unique_ptr<PartitionMatroid> PartitionMatroid::Condition(
+    const std::vector<int>& S) const {
+  std::vector<int> groups = groups_;
+  std::vector<int> ks = ks_;
+  const int s_group = num_groups_;
+  int s_size = 0;
+  for (int element : S) {
+    const int group = GroupOf(element);
+    if (groups[element] == s_group) {
+      // Repeated in S.
+      continue;
+    }
+    groups[element] = s_group;
+    ++s_size;
+    if (--ks[group] < 0) {
+      return nullptr;
+    }
+  }
+  // At most |S| elements of S can be current, so this bound never blocks.
+  ks.push_back(s_size);
+  return std::unique_ptr<PartitionMatroid>(
+      new PartitionMatroid(std::move(groups), std::move(ks)));
 }
 
 std::unique_ptr<Matroid> PartitionMatroid::Clone() const {
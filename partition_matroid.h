@@ -4,12 +4,18 @@
 #ifndef FAIR_SUBMODULAR_MATROID_PARTITION_MATROID_H_
 #define FAIR_SUBMODULAR_MATROID_PARTITION_MATROID_H_
 
+#include <cassert>
 #include <map>
 #include <memory>
-#include <set>
+#include <utility>
 #include <vector>
 
 #include "matroid.h"
+#include "sparse_set.h"
+
+// Groups are stored in an array indexed by element, and the current members
+// of each group are kept in a sorted list, so CanAdd takes O(1) time and
+// GetAllSwaps for an element whose group is full takes O(group bound) time.
 
 class PartitionMatroid : public Matroid {
  public:
@@ -27,7 +33,8 @@ class PartitionMatroid : public Matroid {
   // Return whether add element while removing anothe one would be feasible.
   bool CanSwap(int element, int swap) const override;
 
-  // Returns all possible swaps for a given new element.
+  // Returns all possible swaps for a given new element, i.e., the current
+  // members of its group if the group is full.
   std::vector<int> GetAllSwaps(int elements) const override;
 
   // Add an element. Assumes that the element can be added.
@@ -39,11 +46,11 @@ class PartitionMatroid : public Matroid {
   // Checks if a set is feasible.
   bool IsFeasible(const std::vector<int>& elements) const override;
 
-  // Checks whether the current set is feasible.
+  // Checks whether the current set is feasible. Takes O(1) time.
   bool CurrentIsFeasible() const override;
 
-  // Return the current set.
-  std::vector<int> GetCurrent() const override;
+  // Returns the current set, in no particular order.
+  const std::vector<int>& CurrentMembers() const override;
 
   // Returns the group of an element.
   int GetGroup(int element) const;
@@ -51,15 +58,35 @@ class PartitionMatroid : public Matroid {
   // Returns number of groups. 
   int GetGroupsNum() const;
 
+  // Returns the upper bound of a group.
+  int GetGroupBound(int group) const;
+
   // Returns whether an element is in the current set.
   bool InCurrent(int element) const override;
 
+  // Returns the partition matroid in which X is independent iff X u S is
+  // independent in this matroid, i.e., the ConditionedMatroid of this matroid
+  // and S: the elements of S form a new group that never blocks, and the
+  // bound of every other group is lowered by its number of elements in S.
+  // Returns nullptr if S is not independent. The result starts empty.
+  std::unique_ptr<PartitionMatroid> Condition(const std::vector<int>& S) const;
+
   // Clone the object.
   std::unique_ptr<Matroid> Clone() const override;
 
  private:
-  // Map universe elements to groups
-  std::map<int, int> groups_map_;
+  // groups[e] is the group of element e, or -1 if e is not in the universe.
+  PartitionMatroid(std::vector<int> groups, std::vector<int> ks);
+
+  // Returns the group of an element, which must belong to the universe.
+  int GroupOf(int element) const {
+    assert(element >= 0 && element < groups_.size() && groups_[element] >= 0);
+    return groups_[element];
+  }
+
+  // groups_[e] is the group of universe element e, or -1 if e is not in the
+  // universe
+  std::vector<int> groups_;
 
   // Groups upper bounds
   std::vector<int> ks_;
@@ -67,11 +94,14 @@ class PartitionMatroid : public Matroid {
   // Number of groups
   int num_groups_;
 
-  // Current number of elements per group
-  std::vector<int> current_grpcards_;
+  // Current elements of each group, in increasing order
+  std::vector<std::vector<int>> group_members_;
+
+  // Number of groups whose current number of elements exceeds their bound
+  int num_groups_over_bound_ = 0;
 
   // Current set
-  std::set<int> current_set_;
+  SparseSet current_set_;
 };
 
 #endif  // FAIR_SUBMODULAR_MATROID_PARTITION_MATROID_H_
@@ -34,7 +34,7 @@ double RandomAlgorithm::GetSolutionValue() {
   return sub_func_f_->ObjectiveAndIncreaseOracleCall(solution_);
 }
 
-std::vector<int> RandomAlgorithm::GetSolutionVector() {
+const std::vector<int>& RandomAlgorithm::GetSolutionVector() {
   return solution_;
 }
 
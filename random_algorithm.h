@@ -28,7 +28,7 @@ class RandomAlgorithm : public Algorithm {
   double GetSolutionValue();
 
   // Gets current solution.
-  std::vector<int> GetSolutionVector();
+  const std::vector<int>& GetSolutionVector();
 
   // Gets the name of the algorithm.
   std::string GetAlgorithmName() const;
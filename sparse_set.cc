@@ -0,0 +1,20 @@
+// Copyright 2025 The Authors (see AUTHORS file)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "sparse_set.h"
+
+#include <algorithm>
+#include <vector>
+
+void SparseSet::Clear() {
+  for (int element : members_) {
+    positions_[element] = -1;
+  }
+  members_.clear();
+}
+
+void SparseSet::Grow(int element) {
+  // Grow geometrically so that inserting increasing elements stays amortized
+  // O(1).
+  positions_.resize(std::max<size_t>(element + 1, 2 * positions_.size()), -1);
+}
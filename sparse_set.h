@@ -0,0 +1,77 @@
+// Copyright 2025 The Authors (see AUTHORS file)
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef FAIR_SUBMODULAR_MATROID_SPARSE_SET_H_
+#define FAIR_SUBMODULAR_MATROID_SPARSE_SET_H_
+
+#include <cassert>
+#include <vector>
+
+// A set of non-negative integers (universe elements) stored as a dense array
+// of its members plus a position index over the element range. Insert, Erase
+// and Contains take O(1) time, Clear takes O(size) time, and the members can
+// be iterated contiguously. The index grows to the largest element inserted.
+//
+// Members are iterated in insertion order, except that erasing an element
+// moves the last member into its place; callers needing a canonical order
+// must sort.
+
+class SparseSet {
+ public:
+  SparseSet() = default;
+
+  // Returns whether element is a member.
+  bool Contains(int element) const {
+    assert(element >= 0);
+    return element < positions_.size() && positions_[element] >= 0;
+  }
+
+  // Adds element, which must not be a member.
+  void Insert(int element) {
+    assert(!Contains(element));
+    if (element >= positions_.size()) {
+      Grow(element);
+    }
+    positions_[element] = members_.size();
+    members_.push_back(element);
+  }
+
+  // Removes element, which must be a member.
+  void Erase(int element) {
+    assert(Contains(element));
+    const int position = positions_[element];
+    const int last = members_.back();
+    members_[position] = last;
+    positions_[last] = position;
+    members_.pop_back();
+    positions_[element] = -1;
+  }
+
+  // Removes all members.
+  void Clear();
+
+  // Returns the number of members.
+  int size() const { return members_.size(); }
+
+  // Returns whether there are no members.
+  bool empty() const { return members_.empty(); }
+
+  // Iteration over the members.
+  std::vector<int>::const_iterator begin() const { return members_.begin(); }
+  std::vector<int>::const_iterator end() const { return members_.end(); }
+
+  // Returns the members as a contiguous array.
+  const std::vector<int>& members() const { return members_; }
+
+ private:
+  // Extends the position index to cover element.
+  void Grow(int element);
+
+  // The members, contiguously.
+  std::vector<int> members_;
+
+  // positions_[e] is the index of e in members_, or -1 if e is not a member.
+  std::vector<int> positions_;
+};
+
+#endif  // FAIR_SUBMODULAR_MATROID_SPARSE_SET_H_
@@ -10,6 +10,14 @@
 
 #include "utilities.h"
 
+namespace {
+
+// Smallest number of elements worth handing to a thread of
+// ParallelDeltaBatchAndIncreaseOracleCall().
+constexpr int kMinElementsPerThread = 64;
+
+}  // namespace
+
 void SubmodularFunction::Swap(int element, int swap) {
   Remove(swap);
   Add(element);
@@ -26,6 +34,49 @@ double SubmodularFunction::DeltaAndIncreaseOracleCall(int element) {
   return Delta(element);
 }
 
+void SubmodularFunction::DeltaBatchAndIncreaseOracleCall(
+    const std::vector<int>& elements, std::vector<double>* deltas) {
+  oracle_calls_ += elements.size();
+  deltas->resize(elements.size());
+  DeltaBatch(elements, deltas);
+}
+
+void SubmodularFunction::ParallelDeltaBatchAndIncreaseOracleCall(
+    const std::vector<int>& elements,
+    const std::vector<SubmodularFunction*>& replicas,
+    std::vector<double>* deltas) {
+  const int num_slices = std::max<int>(
+      1, std::min<int>(replicas.size() + 1,
+                       elements.size() / kMinElementsPerThread));
+  if (num_slices == 1) {
+    DeltaBatchAndIncreaseOracleCall(elements, deltas);
+    return;
+  }
+  // Only the calling thread touches the (static) counter.
+  oracle_calls_ += elements.size();
+  deltas->resize(elements.size());
+  const int64_t size = elements.size();
+  ParallelFor(num_slices, num_slices, [&](int slice) {
+    SubmodularFunction* function = slice == 0 ? this : replicas[slice - 1];
+    const int begin = size * slice / num_slices;
+    const int end = size * (slice + 1) / num_slices;
+    const std::vector<int> slice_elements(elements.begin() + begin,
+                                          elements.begin() + end);
+    std::vector<double> slice_deltas(slice_elements.size());
+    function->DeltaBatch(slice_elements, &slice_deltas);
+    std::copy(slice_deltas.begin(), slice_deltas.end(),
+              deltas->begin() + begin);
+  });
+}
+
+void SubmodularFunction::DeltaBatch(const std::vector<int>& elements,
+                                    std::vector<double>* deltas) {
+  // default implementation, can be overloaded by something more efficient
+  for (int i = 0; i < elements.size(); ++i) {
+    (*deltas)[i] = Delta(elements[i]);
+  }
+}
+
 double SubmodularFunction::RemovalDeltaAndIncreaseOracleCall(int element) {
   ++oracle_calls_;
   return RemovalDelta(element);
@@ -57,8 +108,10 @@ std::vector<double> SubmodularFunction::GetOptEstimates(
   // Could optimize: this gets re-estimated every time an algorithm is run.
   static constexpr double epsilon_for_opt_estimates = 0.3;
   double ub_opt = 0.0;
-  for (const auto& e : GetUniverse()) {
-    double delta_e = Delta(e);
+  const std::vector<int>& universe = GetUniverse();
+  std::vector<double> deltas(universe.size());
+  DeltaBatch(universe, &deltas);
+  for (double delta_e : deltas) {
     ub_opt = std::max(ub_opt, delta_e);
   }
   ub_opt *= upper_bound_on_size_of_any_feasible_set;
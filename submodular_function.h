@@ -44,6 +44,21 @@ class SubmodularFunction {
   // and also increases oracle_calls.
   double DeltaAndIncreaseOracleCall(int element);
 
+  // Computes the delta of every element in `elements` w.r.t. the current S
+  // (each as if it were added alone) into `deltas`, which is resized to match.
+  // Costs one oracle call per element.
+  void DeltaBatchAndIncreaseOracleCall(const std::vector<int>& elements,
+                                       std::vector<double>* deltas);
+
+  // Same as DeltaBatchAndIncreaseOracleCall(), but splits `elements` into
+  // contiguous slices that are evaluated in parallel, one by this object and
+  // the others by `replicas`, which must be clones of it with the same S.
+  // The result does not depend on the number of replicas.
+  void ParallelDeltaBatchAndIncreaseOracleCall(
+      const std::vector<int>& elements,
+      const std::vector<SubmodularFunction*>& replicas,
+      std::vector<double>* deltas);
+
   // Adds element if and only if its contribution is >= thre and also increases
   // oracle_calls. Returns the contribution increase (if added, otherwise 0).
   virtual double AddAndIncreaseOracleCall(int element, double thre);
@@ -78,6 +93,13 @@ class SubmodularFunction {
   // Computes f(S u {e}) - f(S).
   virtual double Delta(int element) = 0;
 
+  // Computes f(S u {e}) - f(S) for every e in `elements` into `deltas`
+  // (already sized to match). The default implementation calls Delta() once
+  // per element; functions that can walk their state once for the whole batch
+  // should override it.
+  virtual void DeltaBatch(const std::vector<int>& elements,
+                          std::vector<double>* deltas);
+
   // Computes f(S) - f(S - e).
   // Assumes (without checking) that e is in S.
   virtual double RemovalDelta(int element) = 0;
@@ -0,0 +1,119 @@
+// Copyright 2025 The Authors (see AUTHORS file)
+// SPDX-License-Identifier: Apache-2.0
+
+#include "subroutine_cache.h"
+
+#include <stdint.h>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "fairness_constraint.h"
+#include "matroid.h"
+#include "matroid_intersection.h"
+#include "partition_matroid.h"
+#include "submodular_function.h"
+
+const SubroutineCache::Entry* SubroutineCache::Find(
+    const std::vector<Entry>& entries, const std::vector<int>& elements,
+    const std::vector<int>& start) {
+  for (const Entry& entry : entries) {
+    if (entry.elements == elements && entry.start == start) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+void SubroutineCache::LowerBoundMaxIntersection(
+    Matroid* matroid, Matroid* lower_bound_matroid,
+    const std::vector<int>& elements, const std::vector<int>& start) {
+  const Entry* entry = Find(lower_bound_max_intersections_, elements, start);
+  if (entry != nullptr) {
+    matroid->Reset();
+    lower_bound_matroid->Reset();
+    for (int element : entry->result) {
+      matroid->Add(element);
+      lower_bound_matroid->Add(element);
+    }
+    return;
+  }
+  ::MaxIntersection(matroid, lower_bound_matroid, elements, start);
+  const std::vector<int> result = matroid->GetCurrent();
+  lower_bound_max_intersections_.push_back({elements, start, result});
+  // A maximum set is kept as it is when it is the start, so this is also the
+  // result for starting from it (as callers warm-started with it do).
+  if (result != start) {
+    lower_bound_max_intersections_.push_back({elements, result, result});
+  }
+}
+
+std::vector<int> SubroutineCache::FairMaxIntersection(
+    Matroid* matroid, FairnessConstraint* fairness,
+    const std::vector<int>& elements) {
+  const Entry* entry = Find(fair_max_intersections_, elements, {});
+  if (entry != nullptr) {
+    matroid->Reset();
+    for (int element : entry->result) {
+      matroid->Add(element);
+    }
+    return entry->result;
+  }
+  std::vector<int> result = ::FairMaxIntersection(matroid, fairness, elements);
+  fair_max_intersections_.push_back({elements, {}, result});
+  return result;
+}
+
+std::vector<int> SubroutineCache::UpperBoundGreedy(
+    Matroid* matroid, Matroid* upper_bound_matroid,
+    SubmodularFunction* sub_func_f, const std::vector<int>& universe,
+    const GreedyOptions& options) {
+  if (options.evaluation == STOCHASTIC_GREEDY ||
+      matroid->CurrentSize() != 0 ||
+      upper_bound_matroid->CurrentSize() != 0) {
+    return Greedy(matroid, upper_bound_matroid, sub_func_f, universe,
+                  options);
+  }
+  // Cached results are for an empty function, whose state cannot be checked
+  // like that of the matroids, so start from one.
+  sub_func_f->Reset();
+  std::vector<Entry>& entries =
+      upper_bound_greedy_[{options.evaluation, options.epsilon}];
+  const Entry* entry = Find(entries, universe, {});
+  if (entry != nullptr) {
+    for (int element : entry->result) {
+      matroid->Add(element);
+      upper_bound_matroid->Add(element);
+      sub_func_f->Add(element);
+    }
+    SubmodularFunction::oracle_calls_ += entry->oracle_calls;
+    return entry->result;
+  }
+  const int64_t oracle_calls_before = SubmodularFunction::oracle_calls_;
+  std::vector<int> result =
+      Greedy(matroid, upper_bound_matroid, sub_func_f, universe, options);
+  entries.push_back({universe, {}, result,
+                     SubmodularFunction::oracle_calls_ - oracle_calls_before});
+  return result;
+}
+
+FairPathDecomposition SubroutineCache::DecomposeFairPaths(
+    PartitionMatroid* matroid, FairnessConstraint* fairness,
+    SubmodularFunction* sub_func_f, const GreedyOptions& options) {
+  if (options.evaluation == STOCHASTIC_GREEDY) {
+    return ::DecomposeFairPaths(matroid, fairness, sub_func_f, options, this);
+  }
+  std::vector<DecompositionEntry>& entries =
+      fair_path_decompositions_[{options.evaluation, options.epsilon}];
+  for (const DecompositionEntry& entry : entries) {
+    if (entry.universe == sub_func_f->GetUniverse()) {
+      SubmodularFunction::oracle_calls_ += entry.decomposition.oracle_calls;
+      return entry.decomposition;
+    }
+  }
+  FairPathDecomposition decomposition =
+      ::DecomposeFairPaths(matroid, fairness, sub_func_f, options, this);
+  entries.push_back({sub_func_f->GetUniverse(), decomposition});
+  return decomposition;
+}
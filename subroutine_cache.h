@@ -0,0 +1,102 @@
+// Copyright 2025 The Authors (see AUTHORS file)
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef FAIR_SUBMODULAR_MATROID_SUBROUTINE_CACHE_H_
+#define FAIR_SUBMODULAR_MATROID_SUBROUTINE_CACHE_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "fairness_constraint.h"
+#include "matroid.h"
+#include "matroid_intersection.h"
+#include "partition_matroid.h"
+#include "submodular_function.h"
+
+// Results of deterministic subroutines that several algorithms compute for
+// the same function, matroid and fairness constraint (e.g. the runs for one
+// rank). The caller creates one cache per such combination and passes it to
+// Algorithm::SetSubroutineCache(); algorithms then call the methods below
+// instead of the subroutines of the same name.
+//
+// Each method has the same result and the same effect on its arguments as
+// the subroutine (a set is added to the matroids and the function in a
+// possibly different order), and adds the oracle calls the subroutine made
+// to SubmodularFunction::oracle_calls_ even if the result is reused, so
+// oracle call counts do not depend on the cache.
+
+class SubroutineCache {
+ public:
+  SubroutineCache() = default;
+
+  // Forbids copying.
+  SubroutineCache(const SubroutineCache&) = delete;
+  SubroutineCache& operator=(const SubroutineCache&) = delete;
+
+  // MaxIntersection(matroid, lower_bound_matroid, elements, start), where
+  // lower_bound_matroid is LowerBoundsToMatroid() of the fairness constraint.
+  void LowerBoundMaxIntersection(Matroid* matroid, Matroid* lower_bound_matroid,
+                                 const std::vector<int>& elements,
+                                 const std::vector<int>& start);
+
+  // FairMaxIntersection(matroid, fairness, elements).
+  std::vector<int> FairMaxIntersection(Matroid* matroid,
+                                       FairnessConstraint* fairness,
+                                       const std::vector<int>& elements);
+
+  // Greedy(matroid, upper_bound_matroid, sub_func_f, universe, options),
+  // where upper_bound_matroid is UpperBoundsToMatroid() of the fairness
+  // constraint. Only reuses results if the matroids start empty and the
+  // greedy variant is not randomized; in that case it first resets
+  // sub_func_f, since the function state cannot be checked, so callers must
+  // not rely on a partial solution in it.
+  std::vector<int> UpperBoundGreedy(Matroid* matroid,
+                                    Matroid* upper_bound_matroid,
+                                    SubmodularFunction* sub_func_f,
+                                    const std::vector<int>& universe,
+                                    const GreedyOptions& options);
+
+  // DecomposeFairPaths(matroid, fairness, sub_func_f, options, this). Only
+  // reuses results if the greedy variant is not randomized. Unlike the
+  // methods above, a reused result is not replayed on the arguments, which
+  // callers reset before using them.
+  FairPathDecomposition DecomposeFairPaths(PartitionMatroid* matroid,
+                                           FairnessConstraint* fairness,
+                                           SubmodularFunction* sub_func_f,
+                                           const GreedyOptions& options);
+
+ private:
+  // A computed result, with the input elements it was computed for.
+  struct Entry {
+    std::vector<int> elements;
+    std::vector<int> start;
+    std::vector<int> result;
+    int64_t oracle_calls = 0;
+  };
+
+  // Returns the entry in `entries` for these inputs, or nullptr.
+  static const Entry* Find(const std::vector<Entry>& entries,
+                           const std::vector<int>& elements,
+                           const std::vector<int>& start);
+
+  std::vector<Entry> lower_bound_max_intersections_;
+  std::vector<Entry> fair_max_intersections_;
+
+  // Keyed by (evaluation, epsilon) of the greedy options.
+  std::map<std::pair<int, double>, std::vector<Entry>> upper_bound_greedy_;
+
+  // A computed decomposition, with the universe it was computed for.
+  struct DecompositionEntry {
+    std::vector<int> universe;
+    FairPathDecomposition decomposition;
+  };
+
+  // Keyed by (evaluation, epsilon) of the greedy options.
+  std::map<std::pair<int, double>, std::vector<DecompositionEntry>>
+      fair_path_decompositions_;
+};
+
+#endif  // FAIR_SUBMODULAR_MATROID_SUBROUTINE_CACHE_H_
@@ -74,8 +74,14 @@ void TwoPassAlgorithmWithConditionedMatroid::FindFeasibleSolution() {
   }*/
   matroid_->Reset();
   fairness_->Reset();
-  MaxIntersection(matroid_.get(), fairness_->LowerBoundsToMatroid().get(),
-                  universe_elements_);
+  std::unique_ptr<Matroid> lower_matroid = fairness_->LowerBoundsToMatroid();
+  if (cache_ != nullptr) {
+    cache_->LowerBoundMaxIntersection(matroid_.get(), lower_matroid.get(),
+                                      universe_elements_, warm_start_);
+  } else {
+    MaxIntersection(matroid_.get(), lower_matroid.get(), universe_elements_,
+                    warm_start_);
+  }
   first_round_solution_ = matroid_->GetCurrent();
 }
 
@@ -98,15 +104,16 @@ std::vector<int> TwoPassAlgorithmWithConditionedMatroid::SecondPass(
   sub_func_f_->Reset();
   weights_.clear();
 
-  ConditionedMatroid condmatroid(*matroid_, start_solution);
+  std::unique_ptr<Matroid> condmatroid =
+      MakeConditionedMatroid(*matroid_, start_solution);
 
   std::unique_ptr<Matroid> color_mat = fairness_->UpperBoundsToMatroid();
   color_mat->Reset();
   if (use_greedy_) {
-    Greedy(&condmatroid, color_mat.get(), sub_func_f_.get(),
-                     universe_elements_);
+    Greedy(condmatroid.get(), color_mat.get(), sub_func_f_.get(),
+                     universe_elements_, greedy_options_);
   } else {
-    SubMaxIntersectionSwapping(&condmatroid, color_mat.get(), sub_func_f_.get(),
+    SubMaxIntersectionSwapping(condmatroid.get(), color_mat.get(), sub_func_f_.get(),
                      universe_elements_);
   }
 
@@ -121,19 +128,20 @@ std::vector<int> TwoPassAlgorithmWithConditionedMatroid::SecondPass(
   // find the best subset of start_solution to add by
   // max {F(S U S_current) : S subset of S_start, S U S_current in I^C}.
   UniformMatroid dummy_mat(1'000'000'000);
-  ConditionedMatroid cond_fairness(*color_mat, current_sol);
+  std::unique_ptr<Matroid> cond_fairness =
+      MakeConditionedMatroid(*color_mat, current_sol);
   // sub_func_f_ already has current sol.
   // dummy_mat has nothing.
   // cond_fairness also has nothing (it's reset when created).
   if (use_greedy_) {
-    Greedy(&dummy_mat, &cond_fairness, sub_func_f_.get(),
-                     start_solution_not_chosen);
+    Greedy(&dummy_mat, cond_fairness.get(), sub_func_f_.get(),
+                     start_solution_not_chosen, greedy_options_);
   } else {
-    SubMaxIntersectionSwapping(&dummy_mat, &cond_fairness, sub_func_f_.get(),
+    SubMaxIntersectionSwapping(&dummy_mat, cond_fairness.get(), sub_func_f_.get(),
                      start_solution_not_chosen);
   }
 
-  return append(current_sol, cond_fairness.GetCurrent());
+  return append(current_sol, cond_fairness->GetCurrent());
 }
 
 double TwoPassAlgorithmWithConditionedMatroid::GetSolutionValue() {
@@ -153,10 +161,14 @@ double TwoPassAlgorithmWithConditionedMatroid::GetSolutionValue() {
   return std::max(answer[0].second, answer[1].second);
 }
 
-std::vector<int> TwoPassAlgorithmWithConditionedMatroid::GetSolutionVector() {
+const std::vector<int>&
+TwoPassAlgorithmWithConditionedMatroid::GetSolutionVector() {
   return final_solution_;
 }
 
 std::string TwoPassAlgorithmWithConditionedMatroid::GetAlgorithmName() const {
-  return std::string("Two pass algorithm (") + (use_greedy_ ? "greedy" : "swapping") + ")";
+  const std::string greedy = GreedyOptionsToString(greedy_options_);
+  return std::string("Two pass algorithm (") +
+         (use_greedy_ ? "greedy" : "swapping") +
+         (use_greedy_ && !greedy.empty() ? ": " + greedy : "") + ")";
 }
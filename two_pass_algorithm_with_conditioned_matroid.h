@@ -10,10 +10,16 @@
 #include <vector>
 
 #include "algorithm.h"
+#include "matroid_intersection.h"
 
 class TwoPassAlgorithmWithConditionedMatroid : public Algorithm {
  public:
-  explicit TwoPassAlgorithmWithConditionedMatroid(bool use_greedy_instead_of_swapping) : use_greedy_(use_greedy_instead_of_swapping) {}
+  // greedy_options selects the greedy variant, if greedy is used.
+  explicit TwoPassAlgorithmWithConditionedMatroid(
+      bool use_greedy_instead_of_swapping,
+      const GreedyOptions& greedy_options = GreedyOptions())
+      : use_greedy_(use_greedy_instead_of_swapping),
+        greedy_options_(greedy_options) {}
 
   // Initialize the algorithm state.
   void Init(const SubmodularFunction& sub_func_f,
@@ -27,7 +33,7 @@ class TwoPassAlgorithmWithConditionedMatroid : public Algorithm {
   double GetSolutionValue() override;
 
   // Gets current solution.
-  std::vector<int> GetSolutionVector() override;
+  const std::vector<int>& GetSolutionVector() override;
 
   // Gets the name of the algorithm.
   std::string GetAlgorithmName() const override;
@@ -63,6 +69,9 @@ class TwoPassAlgorithmWithConditionedMatroid : public Algorithm {
 
   // Whether to use Greedy algorithm instead of SubMaxIntersectionSwapping.
   bool use_greedy_;
+
+  // Which variant of Greedy() to use.
+  GreedyOptions greedy_options_;
 };
 
 #endif  // FAIR_SUBMODULAR_MATROID_TWO_PASS_ALGORITHM_WITH_CONDITIONED_MATROID_H_
@@ -3,38 +3,46 @@
 
 #include "uniform_matroid.h"
 
+#include <algorithm>
 #include <cassert>
 #include <memory>
-#include <set>
 #include <vector>
 
 UniformMatroid::UniformMatroid(int k) : k_(k) {}
 
-void UniformMatroid::Reset() { current_set_.clear(); }
+void UniformMatroid::Reset() {
+  sorted_members_.clear();
+  current_set_.Clear();
+}
 
 bool UniformMatroid::CanAdd(int element) const {
-  assert(!current_set_.count(element));
+  assert(!current_set_.Contains(element));
   return current_set_.size() + 1 <= k_;
 }
 
 bool UniformMatroid::CanSwap(int element, int swap) const {
-  assert(!current_set_.count(element));
-  assert(current_set_.count(swap));
+  assert(!current_set_.Contains(element));
+  assert(current_set_.Contains(swap));
   return true;
 }
 
 std::vector<int> UniformMatroid::GetAllSwaps(int element) const {
-  return GetCurrent();
+  return sorted_members_;
 }
 
 void UniformMatroid::Add(int element) {
-  assert(!current_set_.count(element));
-  current_set_.insert(element);
+  assert(!current_set_.Contains(element));
+  sorted_members_.insert(
+      std::lower_bound(sorted_members_.begin(), sorted_members_.end(), element),
+      element);
+  current_set_.Insert(element);
 }
 
 void UniformMatroid::Remove(int element) {
-  assert(current_set_.count(element));
-  current_set_.erase(element);
+  assert(current_set_.Contains(element));
+  sorted_members_.erase(
+      std::lower_bound(sorted_members_.begin(), sorted_members_.end(), element));
+  current_set_.Erase(element);
 }
 
 bool UniformMatroid::IsFeasible(const std::vector<int>& elements) const {
@@ -45,12 +53,12 @@ bool UniformMatroid::CurrentIsFeasible() const {
   return current_set_.size() <= k_;
 }
 
-std::vector<int> UniformMatroid::GetCurrent() const {
-  return std::vector<int>(current_set_.begin(), current_set_.end());
+const std::vector<int>& UniformMatroid::CurrentMembers() const {
+  return current_set_.members();
 }
 
 bool UniformMatroid::InCurrent(int element) const {
-  return current_set_.count(element);
+  return current_set_.Contains(element);
 }
 
 std::unique_ptr<Matroid> UniformMatroid::Clone() const {
@@ -5,10 +5,10 @@
 #define FAIR_SUBMODULAR_MATROID_UNIFORM_MATROID_H_
 
 #include <memory>
-#include <set>
 #include <vector>
 
 #include "matroid.h"
+#include "sparse_set.h"
 
 class UniformMatroid : public Matroid {
  public:
@@ -25,7 +25,8 @@ class UniformMatroid : public Matroid {
   // Return whether add element while removing anothe one would be feasible.
   bool CanSwap(int element, int swap) const override;
 
-  // Returns all possible swaps for a given new element.
+  // Returns all possible swaps for a given new element: the whole current
+  // set, kept sorted so that no query sorts it.
   std::vector<int> GetAllSwaps(int elements) const override;
 
   // Add an element. Assumes that the element can be added.
@@ -40,8 +41,8 @@ class UniformMatroid : public Matroid {
   // Checks whether the current set is feasible.
   bool CurrentIsFeasible() const override;
 
-  // Return the current set.
-  std::vector<int> GetCurrent() const override;
+  // Returns the current set, in no particular order.
+  const std::vector<int>& CurrentMembers() const override;
 
   // Returns whether an element is in the current set.
   bool InCurrent(int element) const override;
@@ -51,7 +52,9 @@ class UniformMatroid : public Matroid {
 
  private:
   // The current set of elements.
-  std::set<int> current_set_;
+  SparseSet current_set_;
+  // The current set in increasing order, returned by GetAllSwaps.
+  std::vector<int> sorted_members_;
   // The cardinality constraint.
   const int k_;
 };
@@ -3,6 +3,7 @@
 
 #include "upper_bound_matroid_intersection_algorithm.h"
 
+#include <iostream>
 #include <memory>
 #include <string>
 #include <vector>
@@ -28,9 +29,25 @@ void UpperBoundMatroidIntersectionAlgorithm::Solve() {
   matroid_->Reset();
   sub_func_f_->Reset();
   auto fairness_matroid = fairness_->UpperBoundsToMatroid();
-  if (use_greedy_) {
+  if (use_greedy_ && continue_greedy_) {
+    if (continuation_ == nullptr ||
+        continuation_->GetUniverse() != universe_elements_) {
+      continuation_ = std::make_unique<GreedyContinuation>(
+          *sub_func_f_, universe_elements_, greedy_options_);
+    }
+    if (!continuation_->Run(matroid_.get(), fairness_matroid.get())) {
+      std::cerr << GetAlgorithmName()
+                << ": the continued greedy solution may differ from a cold "
+                   "start; run without continuation to compare"
+                << std::endl;
+    }
+  } else if (use_greedy_ && cache_ != nullptr) {
+    cache_->UpperBoundGreedy(matroid_.get(), fairness_matroid.get(),
+                             sub_func_f_.get(), universe_elements_,
+                             greedy_options_);
+  } else if (use_greedy_) {
     Greedy(matroid_.get(), fairness_matroid.get(), sub_func_f_.get(),
-                     universe_elements_);
+                     universe_elements_, greedy_options_);
   } else {
     SubMaxIntersectionSwapping(matroid_.get(), fairness_matroid.get(), sub_func_f_.get(),
                      universe_elements_);
@@ -47,7 +64,8 @@ double UpperBoundMatroidIntersectionAlgorithm::GetSolutionValue() {
   return solution_value_;
 }
 
-std::vector<int> UpperBoundMatroidIntersectionAlgorithm::GetSolutionVector() {
+const std::vector<int>&
+UpperBoundMatroidIntersectionAlgorithm::GetSolutionVector() {
   if (solution_vector_.empty()) {
     Solve();
   }
@@ -55,5 +73,10 @@ std::vector<int> UpperBoundMatroidIntersectionAlgorithm::GetSolutionVector() {
 }
 
 std::string UpperBoundMatroidIntersectionAlgorithm::GetAlgorithmName() const {
-  return std::string("Upper bound matroid intersection algorithm (") + (use_greedy_ ? "greedy" : "swapping") + ")";
+  const std::string greedy = GreedyOptionsToString(greedy_options_);
+  return std::string("Upper bound matroid intersection algorithm (") +
+         (use_greedy_ ? "greedy" : "swapping") +
+         (use_greedy_ && !greedy.empty() ? ": " + greedy : "") +
+         (use_greedy_ && continue_greedy_ ? ", continued across ranks" : "") +
+         ")";
 }
@@ -4,18 +4,30 @@
 #ifndef FAIR_SUBMODULAR_MATROID_UPPER_BOUND_MATROID_INTERSECTION_ALGORITHM_H_
 #define FAIR_SUBMODULAR_MATROID_UPPER_BOUND_MATROID_INTERSECTION_ALGORITHM_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "algorithm.h"
 #include "fairness_constraint.h"
 #include "matroid.h"
+#include "matroid_intersection.h"
 #include "submodular_function.h"
 
 class UpperBoundMatroidIntersectionAlgorithm : public Algorithm {
  public:
-  // Constructor with use_greedy flag.
-  explicit UpperBoundMatroidIntersectionAlgorithm(bool use_greedy_instead_of_swapping) : use_greedy_(use_greedy_instead_of_swapping) {}
+  // Constructor with use_greedy flag; greedy_options selects the greedy
+  // variant. With continue_greedy, greedy continues from the solution of the
+  // previous Init() (see GreedyContinuation) if the function and universe
+  // are the same, which is meant for sweeps over growing ranks. Whether the
+  // solution of a rank may differ from a cold start is printed to stderr.
+  explicit UpperBoundMatroidIntersectionAlgorithm(
+      bool use_greedy_instead_of_swapping,
+      const GreedyOptions& greedy_options = GreedyOptions(),
+      bool continue_greedy = false)
+      : use_greedy_(use_greedy_instead_of_swapping),
+        greedy_options_(greedy_options),
+        continue_greedy_(continue_greedy) {}
 
   // Initialize the algorithm state.
   // Default implementation only saves the three parameters' clones into the
@@ -31,7 +43,7 @@ class UpperBoundMatroidIntersectionAlgorithm : public Algorithm {
   double GetSolutionValue() override;
 
   // Gets current solution. Only call this after calling GetSolutionValue().
-  std::vector<int> GetSolutionVector() override;
+  const std::vector<int>& GetSolutionVector() override;
 
   // Gets the name of the algorithm.
   std::string GetAlgorithmName() const override;
@@ -51,6 +63,15 @@ class UpperBoundMatroidIntersectionAlgorithm : public Algorithm {
 
   // Whether to use Greedy algorithm instead of SubMaxIntersectionSwapping.
   bool use_greedy_;
+
+  // Which variant of Greedy() to use.
+  GreedyOptions greedy_options_;
+
+  // Whether to continue greedy across Init() calls.
+  bool continue_greedy_;
+
+  // The greedy state kept across Init() calls if continue_greedy_.
+  std::unique_ptr<GreedyContinuation> continuation_;
 };
 
 #endif  // FAIR_SUBMODULAR_MATROID_UPPER_BOUND_MATROID_INTERSECTION_ALGORITHM_H_
@@ -6,16 +6,149 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
+#include <condition_variable>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
+#include <mutex>
 #include <random>
 #include <string>
+#include <thread>
 #include <vector>
 
 std::mt19937 RandomHandler::generator_;
 
+namespace {
+
+// See SetNumThreads().
+int num_threads_setting = 1;
+
+// Whether the current thread is running iterations of a ParallelFor() call.
+thread_local bool in_parallel_for = false;
+
+// Worker threads shared by all ParallelFor() calls, so that a call only wakes
+// up threads instead of starting new ones. Runs one call at a time.
+class ThreadPool {
+ public:
+  ThreadPool() = default;
+
+  // Forbids copying.
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Calls fn(i) for every i in [0, n) on the calling thread and
+  // num_threads - 1 workers, which are started the first time they are
+  // needed.
+  void Run(int n, int num_threads, const std::function<void(int)>& fn) {
+    std::lock_guard<std::mutex> run_lock(run_mutex_);
+    const int num_workers = num_threads - 1;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      while (workers_.size() < num_workers) {
+        const int index = workers_.size();
+        workers_.emplace_back([this, index]() { WorkerLoop(index); });
+      }
+      fn_ = &fn;
+      n_ = n;
+      next_ = 0;
+      active_workers_ = num_workers;
+      busy_workers_ = num_workers;
+      ++generation_;
+    }
+    wake_up_.notify_all();
+    in_parallel_for = true;
+    Work();
+    in_parallel_for = false;
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this]() { return busy_workers_ == 0; });
+    fn_ = nullptr;
+  }
+
+ private:
+  // Takes iterations until none are left.
+  void Work() {
+    for (int i = next_++; i < n_; i = next_++) {
+      (*fn_)(i);
+    }
+  }
+
+  void WorkerLoop(int index) {
+    in_parallel_for = true;
+    int64_t seen_generation = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_up_.wait(lock, [this, seen_generation]() {
+          return generation_ != seen_generation;
+        });
+        seen_generation = generation_;
+        if (index >= active_workers_) {
+          continue;
+        }
+      }
+      Work();
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--busy_workers_ == 0) {
+        done_.notify_one();
+      }
+    }
+  }
+
+  // Serializes Run() calls.
+  std::mutex run_mutex_;
+
+  // Guards the state below, except next_.
+  std::mutex mutex_;
+  std::condition_variable wake_up_;
+  std::condition_variable done_;
+  std::vector<std::thread> workers_;
+
+  // The current call: incremented per call, the function, the number of
+  // iterations and the next one to take, and how many workers take part and
+  // how many of them are still working.
+  int64_t generation_ = 0;
+  const std::function<void(int)>* fn_ = nullptr;
+  int n_ = 0;
+  std::atomic<int> next_{0};
+  int active_workers_ = 0;
+  int busy_workers_ = 0;
+};
+
+}  // namespace
+
+int HardwareThreads() {
+  static const int num_threads =
+      std::max(1u, std::thread::hardware_concurrency());
+  return num_threads;
+}
+
+void SetNumThreads(int num_threads) {
+  num_threads_setting = num_threads > 0 ? num_threads : HardwareThreads();
+}
+
+int NumThreads() { return num_threads_setting; }
+
+void ParallelFor(int n, const std::function<void(int)>& fn) {
+  ParallelFor(n, NumThreads(), fn);
+}
+
+void ParallelFor(int n, int num_threads, const std::function<void(int)>& fn) {
+  num_threads = std::min(num_threads, n);
+  // Nested calls run serially on the calling thread.
+  if (num_threads <= 1 || in_parallel_for) {
+    for (int i = 0; i < n; ++i) {
+      fn(i);
+    }
+    return;
+  }
+  // Never destroyed; the workers wait for work until the program exits.
+  static ThreadPool* const pool = new ThreadPool();
+  pool->Run(n, num_threads, fn);
+}
+
 std::string PrettyNum(int64_t number) {
   std::string pretty_number = std::to_string(number);
   for (int i = static_cast<int>(pretty_number.size()) - 3; i > 0; i -= 3) {
@@ -6,6 +6,7 @@
 
 #include <stdint.h>
 
+#include <functional>
 #include <random>
 #include <string>
 #include <vector>
@@ -37,6 +38,72 @@ class RandomHandler {
   }
 };
 
+// Returns the number of hardware threads (at least 1).
+int HardwareThreads();
+
+// Sets the number of threads for parallel work; 0 means HardwareThreads().
+// The default is 1, i.e., ParallelFor() runs serially.
+void SetNumThreads(int num_threads);
+
+// Returns the number of threads to use for parallel work (at least 1).
+int NumThreads();
+
+// Calls fn(i) for every i in [0, n), spread over NumThreads() threads.
+// Iterations are handed out one at a time, so they may differ in cost.
+// fn must be safe to call concurrently for different i. The threads are
+// kept between calls; a call from inside fn runs serially.
+void ParallelFor(int n, const std::function<void(int)>& fn);
+
+// Same as above, but with num_threads threads.
+void ParallelFor(int n, int num_threads, const std::function<void(int)>& fn);
+
+// Sorts a vector using ParallelFor: chunks are sorted independently and then
+// merged pairwise. Like std::sort, it is not stable.
+template <typename T, typename Compare>
+void ParallelSort(std::vector<T>& input, const Compare& compare) {
+  const int num_chunks = std::min<int64_t>(NumThreads(), input.size() / 1024);
+  if (num_chunks <= 1) {
+    std::sort(input.begin(), input.end(), compare);
+    return;
+  }
+  std::vector<int64_t> bounds(num_chunks + 1);
+  for (int i = 0; i <= num_chunks; ++i) {
+    bounds[i] = static_cast<int64_t>(input.size()) * i / num_chunks;
+  }
+  ParallelFor(num_chunks, [&](int i) {
+    std::sort(input.begin() + bounds[i], input.begin() + bounds[i + 1],
+              compare);
+  });
+  for (int width = 1; width < num_chunks; width *= 2) {
+    ParallelFor((num_chunks + 2 * width - 1) / (2 * width), [&](int i) {
+      const int left = 2 * width * i;
+      const int middle = std::min(left + width, num_chunks);
+      const int right = std::min(left + 2 * width, num_chunks);
+      std::inplace_merge(input.begin() + bounds[left],
+                         input.begin() + bounds[middle],
+                         input.begin() + bounds[right], compare);
+    });
+  }
+}
+
+// Merges consecutive sorted runs [bounds[i], bounds[i + 1]) of `values` into
+// one sorted sequence, pairwise like ParallelSort. Takes O(n log k) time for
+// n values in k runs.
+template <typename T>
+void MergeSortedRuns(std::vector<T>& values,
+                     const std::vector<int64_t>& bounds) {
+  const int num_runs = static_cast<int>(bounds.size()) - 1;
+  for (int width = 1; width < num_runs; width *= 2) {
+    for (int left = 0; left + width < num_runs; left += 2 * width) {
+      const int middle = left + width;
+      const int right = std::min(left + 2 * width, num_runs);
+      std::inplace_merge(values.begin() + bounds[left],
+                         values.begin() + bounds[middle],
+                         values.begin() + bounds[right]);
+    }
+  }
+}
+
 // Returns a number in a way that is easier to read.
 // Formats numbers like 1078546 -> 1,078,546.
 std::string PrettyNum(int64_t number);